@@ -12,6 +12,7 @@ else()
 endif()
 
 find_package (Python3 COMPONENTS Interpreter)
+find_package (Threads REQUIRED)
 
 # don't use Frameworks on the Mac (#966)
 if (APPLE)
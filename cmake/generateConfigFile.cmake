@@ -26,6 +26,10 @@ set(EXV_UNICODE_PATH     ${EXIV2_ENABLE_WIN_UNICODE})
 check_cxx_symbol_exists(mmap        sys/mman.h     EXV_HAVE_MMAP )
 check_cxx_symbol_exists(munmap      sys/mman.h     EXV_HAVE_MUNMAP )
 check_cxx_symbol_exists(strerror_r  string.h       EXV_HAVE_STRERROR_R )
+check_cxx_symbol_exists(copy_file_range unistd.h   EXV_HAVE_COPY_FILE_RANGE )
+check_cxx_symbol_exists(sendfile    sys/sendfile.h EXV_HAVE_SENDFILE )
+check_cxx_symbol_exists(syncfs      unistd.h       EXV_HAVE_SYNCFS )
+check_cxx_symbol_exists(posix_fadvise fcntl.h      EXV_HAVE_POSIX_FADVISE )
 
 check_cxx_source_compiles( "
 #include <string.h>
@@ -194,6 +194,22 @@ namespace Exiv2 {
                   Nonzero if failure;
          */
         virtual int munmap() =0;
+        /*!
+          @brief Map the IO data like mmap(), without reading data which is
+                 not available yet. Only the parts of the mapped area made
+                 available with populateMap() are guaranteed to contain the
+                 data. The default implementation calls mmap().
+          @return A pointer to the mapped area.
+          @throw Error In case of failure.
+         */
+        virtual const byte* mmapSparse() { return mmap(); }
+        /*!
+          @brief Make \em size bytes at \em offset of the area returned by
+                 mmapSparse() available. The default implementation does
+                 nothing, as all the data is mapped.
+          @throw Error In case of failure.
+         */
+        virtual void populateMap(long /*offset*/, long /*size*/) {}
 
         //@}
 
@@ -240,6 +256,15 @@ namespace Exiv2 {
          */
         virtual void populateFakeData() {}
 
+        /*!
+          @brief Hint that \em size bytes at \em offset are going to be
+                 read soon. Readers call this once they know where the next
+                 structures live. Remote IO fetches the range together with
+                 the next data it has to fetch. The default implementation
+                 does nothing.
+         */
+        virtual void prefetch(long /*offset*/, long /*size*/) {}
+
         /*!
           @brief this is allocated and populated by mmap()
          */
@@ -359,6 +384,17 @@ namespace Exiv2 {
                  0 if failure;
          */
         long write(BasicIo& src) override;
+        /*!
+          @brief Like write(BasicIo&), but write at most \em count bytes.
+              If \em src is a file too, the data is copied by the kernel
+              where supported, without reading it into memory.
+          @param src Reference to another BasicIo instance. Reading start
+              at the source's current IO position
+          @param count Maximum number of bytes to write.
+          @return Number of bytes written to the file successfully;<BR>
+                 0 if failure;
+         */
+        long write(BasicIo& src, long count);
         /*!
           @brief Write one byte to the file. The file position is
               advanced by one byte.
@@ -411,6 +447,10 @@ namespace Exiv2 {
           @note If the caller doesn't have permissions to write to the file,
               an exception is raised and \em src is deleted.
 
+          In atomic write mode, see setAtomicWrite(), and while a WriteBatch
+          is active on the calling thread, the file is replaced atomically
+          instead.
+
           @param src Reference to another BasicIo instance. The entire contents
               of src are transferred to this object. The \em src object is
               invalidated by the method.
@@ -462,9 +502,28 @@ namespace Exiv2 {
          */
         virtual void setPath(const std::wstring& wpath);
 #endif
+        /*!
+          @brief Set the atomic write mode of transfer(). In this mode, the new
+              contents are written to a temporary file in the directory of the
+              file, synced to disk and renamed over the file, so that the file
+              has either its old or its new contents after a crash.
+
+          The default is on if the environment variable EXIV2_ATOMIC_WRITE is
+          set to 1. The mode is only available on platforms with fsync(2),
+          elsewhere it has no effect.
+         */
+        void setAtomicWrite(bool atomic);
+        /*!
+          @brief Hint that \em size bytes at \em offset are going to be
+                 read soon. The file system starts to read them in the
+                 background on platforms with posix_fadvise(2).
+         */
+        void prefetch(long offset, long size) override;
         //@}
         //! @name Accessors
         //@{
+        //! Returns true if transfer() replaces the file atomically
+        bool atomicWrite() const;
         /*!
           @brief Get the current file position.
           @return Offset from the start of the file if successful;<BR>
@@ -517,6 +576,60 @@ namespace Exiv2 {
 
     }; // class FileIo
 
+    /*!
+      @brief Groups the atomic replacements of files on the calling thread,
+          so that they are synced to disk together.
+
+      While a WriteBatch exists, FileIo::transfer() replaces files atomically
+      regardless of FileIo::setAtomicWrite(), but it only prepares the
+      temporary files. commit() syncs all of them, renames them over their
+      files and syncs the directories. Where syncfs(2) is available, this
+      takes one sync per file system and step instead of one per file.
+
+      Until commit() the files keep their old contents. Replacements which
+      are not committed when the batch is destroyed are discarded. Batches
+      can be nested, transfers go to the innermost one.
+     */
+    class EXIV2API WriteBatch {
+    public:
+        //! @name Creators
+        //@{
+        //! Constructor, makes this the active batch of the calling thread
+        WriteBatch();
+        //! Destructor, discards the pending replacements and restores the previous batch
+        ~WriteBatch();
+        //@}
+
+        //! @name Manipulators
+        //@{
+        /*!
+          @brief Sync the pending files, rename them over their files and sync
+              the directories.
+          @throw Error In case of failure, replacements which were not made
+              stay pending.
+         */
+        void commit();
+        //@}
+
+        //! @name Accessors
+        //@{
+        //! Returns the number of pending replacements
+        size_t size() const;
+        //@}
+
+        // NOT IMPLEMENTED
+        //! Copy constructor
+        WriteBatch(const WriteBatch& rhs) = delete;
+        //! Assignment operator
+        WriteBatch& operator=(const WriteBatch& rhs) = delete;
+
+    private:
+        // Pimpl idiom
+        class Impl;
+        std::unique_ptr<Impl> p_;
+
+    }; // class WriteBatch
+
     /*!
       @brief Provides binary IO on blocks of memory by implementing the BasicIo
           interface. A copy-on-write implementation ensures that the data passed
@@ -820,6 +933,11 @@ namespace Exiv2 {
         @brief Provides remote binary file IO by implementing the BasicIo interface. This is an
             abstract class. The logics for remote access are implemented in HttpIo, CurlIo, SshIo which
             are the derived classes of RemoteIo.
+
+            If the environment variable EXIV2_REMOTE_CACHE names a directory, the blocks read from
+            remote files whose ETag or Last-Modified header is known are kept in a cache file in this
+            directory and shared with other processes. EXIV2_REMOTE_CACHE_SIZE sets the size of a new
+            cache file in MB (default 64), the least recently used blocks are replaced when it is full.
     */
     class EXIV2API RemoteIo : public BasicIo {
     public:
@@ -855,7 +973,9 @@ namespace Exiv2 {
           @brief Write data that is read from another BasicIo instance to the remote file.
 
           The write access is done in an efficient way. It only sends the range of different
-          bytes between the current data and BasicIo instance to the remote machine.
+          bytes between the current data and BasicIo instance to the remote machine. If the
+          size is unchanged, each range of blocks which differ is sent separately. If the server
+          rejects the write of a part of the file, the whole file is sent.
 
           @param src Reference to another BasicIo instance. Reading start
               at the source's current IO position
@@ -914,7 +1034,9 @@ namespace Exiv2 {
               the \em src BasicIo object into the empty file.
 
           The write access is done in an efficient way. It only sends the range of different
-          bytes between the current data and BasicIo instance to the remote machine.
+          bytes between the current data and BasicIo instance to the remote machine. If the
+          size is unchanged, each range of blocks which differ is sent separately. If the server
+          rejects the write of a part of the file, the whole file is sent.
 
           @param src Reference to another BasicIo instance. The entire contents
               of src are transferred to this object. The \em src object is
@@ -938,8 +1060,9 @@ namespace Exiv2 {
         int seek(long offset, Position pos) override;
 #endif
        /*!
-         @brief Not support
-         @return NULL
+         @brief Read all the blocks of the remote file which have not been
+                read yet and map the file to a memory block.
+         @return A pointer to the mapped area, which is not written back.
         */
        byte* mmap(bool /*isWriteable*/ = false) override;
        /*!
@@ -947,6 +1070,14 @@ namespace Exiv2 {
          @return 0
         */
        int munmap() override;
+       /*!
+         @brief Map the remote file to a memory block, with the blocks read so
+                far and the ranges to prefetch. Other blocks are read by
+                populateMap() when they are needed.
+        */
+       const byte* mmapSparse() override;
+       //! Read the blocks of the range, if necessary, and copy them to the mapped area
+       void populateMap(long offset, long size) override;
        //@}
        //! @name Accessors
        //@{
@@ -986,6 +1117,12 @@ namespace Exiv2 {
          */
        void populateFakeData() override;
 
+       /*!
+         @brief Remember the range, it is fetched with the next blocks that
+                have to be fetched.
+        */
+       void prefetch(long offset, long size) override;
+
        //@}
 
     protected:
@@ -157,6 +157,7 @@ namespace Exiv2
         std::string boxName(uint32_t box);
         static bool superBox(uint32_t box);
         static bool fullBox(uint32_t box);
+        static bool dataBox(uint32_t box);
         static std::string uuidName(Exiv2::DataBuf& uuid);
 
     };  // class BmffImage
@@ -464,6 +464,13 @@ namespace Exiv2 {
           @throw Error if the makernote cannot be created
          */
         void add(const Exifdatum& exifdatum);
+        /*!
+          @brief Move all Exifdatum instances of \em exifData before position
+                 \em pos, without copying them. \em exifData is empty
+                 afterwards. Iterators to the moved instances remain valid
+                 and refer to this container.
+         */
+        void splice(iterator pos, ExifData& exifData);
         /*!
           @brief Delete the Exifdatum at iterator position \em pos, return the
                  position of the next exifdatum. Note that iterators into
@@ -42,6 +42,7 @@
 #include "exiv2/iptc.hpp"
 #include "exiv2/jp2image.hpp"
 #include "exiv2/jpgimage.hpp"
+#include "exiv2/jsonwriter.hpp"
 #include "exiv2/metadatum.hpp"
 #include "exiv2/mrwimage.hpp"
 #include "exiv2/orfimage.hpp"
@@ -32,7 +32,12 @@ namespace Exiv2
     enum EnVar
     {
         envHTTPPOST = 0,
-        envTIMEOUT = 1
+        envTIMEOUT = 1,
+        envREMOTECACHE = 2,
+        envREMOTECACHESIZE = 3,
+        envATOMICWRITE = 4,
+        envINDEXCACHE = 5,
+        envDECODETHREADS = 6
     };
     //! the collection of protocols.
     enum Protocol
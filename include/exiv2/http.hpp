@@ -26,6 +26,7 @@
 #include "datasets.hpp"
 
 #include <string>
+#include <vector>
 
 
 namespace Exiv2 {
@@ -37,6 +38,19 @@ namespace Exiv2 {
      @return Server response 200 = OK, 404 = Not Found etc...
     */
     EXIV2API int http(Exiv2::Dictionary& request,Exiv2::Dictionary& response,std::string& errors);
+
+    /*!
+     @brief execute HTTP/1.1 requests to one server on a persistent connection.
+            Once the server has kept the connection alive, the requests are
+            pipelined. Idle connections are pooled and reused by later calls
+            for the same server.
+     @param requests  - Dictionaries of headers to send to server, the server of the first request is used for all.
+                        The value of "body", if any, is sent after the headers, which must include its Content-Length
+     @param responses - Dictionaries of response headers and "body", one for each request
+     @param errors    - a String with an error
+     @return Server response of the first request which failed, else of the last request; -1 if there was no response
+    */
+    EXIV2API int http(std::vector<Exiv2::Dictionary>& requests,std::vector<Exiv2::Dictionary>& responses,std::string& errors);
 }
 
 #endif
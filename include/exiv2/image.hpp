@@ -464,7 +464,13 @@ namespace Exiv2 {
              This method is deprecated. Use checkMode() instead.
          */
         bool supportsMetadata(MetadataId metadataId) const;
-        //! Return the flag indicating the source when writing XMP metadata.
+        /*!
+          @brief Return the flag indicating the source when writing XMP
+                 metadata. Also true if the XMP packet read from the image
+                 has not been decoded, because the XMP metadata was never
+                 accessed, and the XMP metadata still has that packet, i.e.,
+                 they were not set from another image.
+         */
         bool writeXmpFromPacket() const;
         //! Return list of native previews. This is meant to be used only by the PreviewManager.
         const NativePreviewList& nativePreviews() const;
@@ -0,0 +1,130 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+/*!
+  @file    jsonwriter.hpp
+  @brief   Streaming JSON export of Exif, IPTC and XMP metadata
+ */
+#ifndef JSONWRITER_HPP_
+#define JSONWRITER_HPP_
+
+#include "exiv2lib_export.h"
+
+// included header files
+#include "types.hpp"
+
+// + standard includes
+#include <iosfwd>
+#include <string>
+
+// *****************************************************************************
+// namespace extensions
+namespace Exiv2 {
+
+// *****************************************************************************
+// class declarations
+    class ExifData;
+    class IptcData;
+    class XmpData;
+    class Image;
+
+// *****************************************************************************
+// class definitions
+
+    /*!
+      @brief Write metadata to an output stream as JSON.
+
+      The JSON text is generated while iterating over the metadata, no
+      document tree is built in memory. The text of an object is collected
+      in a string and written to the stream when it is complete, so that a
+      failure while reading the metadata does not leave a partial object in
+      the output. Each call to write() produces one JSON object. Its members are the metadata families ("Exif", "Iptc",
+      "Xmp"), which contain one object per group, keyed by the tag name.
+      XMP structures and arrays are nested accordingly and the "Xmp" object
+      has an additional "xmlns" member with the namespaces used. This is the
+      layout of the exiv2json sample.
+
+      Values with a single integer, floating point or rational component are
+      written as a number or a [numerator, denominator] pair, values with
+      several components as an array of these. Language alternatives are
+      written as {"lang": {"x-default": "..."}}, all other values as strings.
+
+      With format \c ndjson, each object is written on a single line and
+      terminated with a newline, so that the output for a batch of files is
+      newline-delimited JSON. With format \c json, the objects for a batch
+      of files can be written as the elements of an array, see beginArray().
+     */
+    class EXIV2API JsonWriter {
+    public:
+        //! Output formats
+        enum Format {
+            json,   //!< Indented JSON
+            ndjson  //!< One line of JSON per object
+        };
+
+        //! @name Creators
+        //@{
+        //! Constructor, takes the output stream and the output format
+        explicit JsonWriter(std::ostream& os, Format format =json);
+        //@}
+
+        //! @name Manipulators
+        //@{
+        /*!
+          @brief Write one JSON object with the metadata of \em image, which
+                 must have been read with Image::readMetadata() before.
+
+          @param image         Image to write the metadata of.
+          @param path          If not empty, added as "path" member.
+          @param metadataTypes Bitmap of MetadataId values, selects the
+                               metadata families to write.
+         */
+        void write(const Image& image,
+                   const std::string& path ="",
+                   int metadataTypes =mdExif | mdIptc | mdXmp);
+        //! Write one JSON object with the metadata provided.
+        void write(const ExifData& exifData,
+                   const IptcData& iptcData,
+                   const XmpData& xmpData,
+                   const std::string& path ="");
+        /*!
+          @brief Start a JSON array, the objects written until endArray() is
+                 called are its elements. Has no effect with format \c ndjson,
+                 which writes one line per object.
+         */
+        void beginArray();
+        //! End the JSON array started with beginArray(), if any.
+        void endArray();
+        //@}
+
+    private:
+        //! Write the text of an object, as an element if an array is open
+        void writeObject(const std::string& text);
+
+        // DATA
+        std::ostream& os_;                      //!< Output stream
+        Format format_;                         //!< Output format
+        bool array_{false};                     //!< An array is open
+        long count_{0};                         //!< Number of elements of the array
+
+    }; // class JsonWriter
+
+}                                       // namespace Exiv2
+
+#endif                                  // #ifndef JSONWRITER_HPP_
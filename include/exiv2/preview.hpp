@@ -175,6 +175,33 @@ namespace Exiv2 {
           @brief Return the preview image for the given preview properties.
          */
         PreviewImage getPreviewImage(const PreviewProperties& properties) const;
+        /*!
+          @brief Get the range of the image which holds the preview image for
+                 the given preview properties as it is, without copying it.
+
+          @param properties Preview image properties.
+          @param offset Set to the offset of the preview image in the image.
+          @param size Set to the size of the preview image in bytes.
+          @return true if the preview image is stored in one piece in the
+                  image, false if it is decoded or assembled from several
+                  parts; then \em offset and \em size are not changed.
+         */
+        bool getPreviewRange(const PreviewProperties& properties, long& offset, long& size) const;
+        /*!
+          @brief Write the preview image for the given preview properties to
+                 the current position of \em io.
+
+          A preview image which is stored in one piece in the image is copied
+          directly from the image IO, if \em io is a file, by the kernel,
+          see FileIo::write(BasicIo&, long). Otherwise the preview image is
+          read with getPreviewImage() and written.
+
+          @param properties Preview image properties.
+          @param io IO to write to, which must be open.
+          @return The number of bytes written.
+          @throw Error if the preview image cannot be read or written.
+         */
+        long copyPreview(const PreviewProperties& properties, BasicIo& io) const;
         //@}
 
     private:
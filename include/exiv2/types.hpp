@@ -521,6 +521,14 @@ namespace Exiv2 {
 //! Macro to determine the size of an array
 #define EXV_COUNTOF(a) (sizeof(Exiv2::sizer(a)))
 
+    /*!
+      @brief Append the decimal representation of \em value to \em buf.
+             The result is the same as that of <code>os << value</code> for
+             an output stream with the classic locale, without the cost of
+             constructing a stream.
+     */
+    EXIV2API void appendDecimal(std::string& buf, int64_t value);
+
     //! Utility function to convert the argument of any type to a string
     template<typename T>
     std::string toString(const T& arg)
@@ -27,6 +27,9 @@
 #include "metadatum.hpp"
 #include "properties.hpp"
 
+// + standard includes
+#include <atomic>
+
 // *****************************************************************************
 // namespace extensions
 namespace Exiv2 {
@@ -166,6 +169,14 @@ namespace Exiv2 {
     public:
         //! Default constructor
         XmpData() = default;
+        //! Copy constructor, a packet which is not decoded yet is copied as it is
+        XmpData(const XmpData& rhs);
+        //! Move constructor
+        XmpData(XmpData&& rhs) = default;
+        //! Assignment operator, a packet which is not decoded yet is copied as it is
+        XmpData& operator=(const XmpData& rhs);
+        //! Move assignment operator
+        XmpData& operator=(XmpData&& rhs) = default;
 
         //! XmpMetadata iterator type
         typedef XmpMetadata::iterator iterator;
@@ -247,16 +258,53 @@ namespace Exiv2 {
         bool usePacket(bool b) { bool r = usePacket_; usePacket_=b ; return r; };
         //! setPacket
         void setPacket(const std::string& xmpPacket) { xmpPacket_ = xmpPacket ; usePacket(false); };
+        /*!
+          @brief Replace the metadata with that of the raw XMP packet
+                 \em xmpPacket. Unlike XmpParser::decode(), the packet is
+                 only stored and decoded on first access to the metadata,
+                 so that it is not parsed at all if only the packet is used.
+                 A failure to decode the packet is reported as a warning
+                 at that time.
+         */
+        void setPacketDeferred(const std::string& xmpPacket);
         // ! getPacket
         const std::string& xmpPacket() const { return xmpPacket_ ; };
+        //! Return true if the packet set with setPacketDeferred() is not decoded yet
+        bool decodePending() const { return state_.value_.load(std::memory_order_acquire) != DecodeState::decoded; }
 
         //@}
 
     private:
+        //! State of the packet set with setPacketDeferred(), copied by value
+        struct DecodeState {
+            enum : char { decoded, pending, busy };
+            DecodeState() = default;
+            DecodeState(const DecodeState& rhs) : value_(rhs.value_.load()) {}
+            DecodeState& operator=(const DecodeState& rhs) { value_.store(rhs.value_.load()); return *this; }
+            mutable std::atomic<char> value_{decoded};
+        };
+
+        /*!
+          @brief Decode the packet set with setPacketDeferred(), if not done
+                 yet. The const accessors decode it on first use, so this
+                 locks the container, which keeps concurrent reads of the
+                 same const container safe.
+         */
+        void decodeDeferred() const;
+        /*!
+          @brief Lock a container with a packet which is not decoded yet.
+                 Wait while another thread decodes or copies it.
+          @return true if the container was locked, false if there is
+                  nothing to decode
+         */
+        bool lockPending() const;
+
         // DATA
-        XmpMetadata xmpMetadata_;
+        mutable XmpMetadata xmpMetadata_;
         std::string xmpPacket_  ;
         bool usePacket_{};
+        //! Fits next to usePacket_, sizeof(XmpData) is not changed
+        DecodeState state_;
     }; // class XmpData
 
     /*!
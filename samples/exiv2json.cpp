@@ -19,6 +19,8 @@
  */
 // exiv2json.cpp
 // Sample program to print metadata in JSON format
+// It builds a document tree with Jzon, see Exiv2::JsonWriter (exiv2 -P json)
+// for a writer which streams the JSON text from the metadata
 
 #include <exiv2/exiv2.hpp>
 #include "Jzon.h"
@@ -34,6 +34,7 @@
 #include "exif.hpp"
 #include "easyaccess.hpp"
 #include "iptc.hpp"
+#include "jsonwriter.hpp"
 #include "xmp_exiv2.hpp"
 #include "preview.hpp"
 #include "futils.hpp"
@@ -251,6 +252,16 @@ namespace Action {
     }
 
     int Print::run(const std::string& path)
+    {
+        int rc = runMode(path);
+        // -P json prints one array with the objects of several files
+        if (jsonWriter_ && ++jsonFiles_ == Params::instance().files_.size()) {
+            jsonWriter_->endArray();
+        }
+        return rc;
+    }
+
+    int Print::runMode(const std::string& path)
     {
         try {
             path_ = path;
@@ -258,6 +269,8 @@ namespace Action {
             switch (Params::instance().printMode_) {
                 case Params::pmSummary:   rc = Params::instance().greps_.empty() ? printSummary() : printList(); break;
                 case Params::pmList:      rc = printList();        break;
+                case Params::pmJson:      rc = printJson(false);   break;
+                case Params::pmNdJson:    rc = printJson(true);    break;
                 case Params::pmComment:   rc = printComment();     break;
                 case Params::pmPreview:   rc = printPreviewList(); break;
                 case Params::pmStructure: rc = printStructure(std::cout,Exiv2::kpsBasic, path_)     ; break;
@@ -437,6 +450,44 @@ namespace Action {
         return printMetadata(image.get());
     } // Print::printList
 
+    int Print::printJson(bool ndjson)
+    {
+        if (!jsonWriter_) {
+            jsonWriter_ = std::make_shared<Exiv2::JsonWriter>(std::cout, ndjson ? Exiv2::JsonWriter::ndjson
+                                                                                : Exiv2::JsonWriter::json);
+            if (Params::instance().files_.size() > 1) jsonWriter_->beginArray();
+        }
+        if (!Exiv2::fileExists(path_, true)) {
+            std::cerr << path_
+                      << ": " << _("Failed to open the file\n");
+            return -1;
+        }
+        Exiv2::Image::UniquePtr image = Exiv2::ImageFactory::open(path_);
+        assert(image.get() != 0);
+        image->readMetadata();
+        Exiv2::JsonWriter& writer = *jsonWriter_;
+        const std::string path = Params::instance().files_.size() > 1 ? path_ : "";
+        if (Params::instance().greps_.empty() && Params::instance().keys_.empty()) {
+            writer.write(*image, path);
+            return 0;
+        }
+        // Apply the -g and -K options
+        Exiv2::ExifData exifData;
+        for (auto&& md : image->exifData()) {
+            if (grepTag(md.key()) && keyTag(md.key())) exifData.add(md);
+        }
+        Exiv2::IptcData iptcData;
+        for (auto&& md : image->iptcData()) {
+            if (grepTag(md.key()) && keyTag(md.key())) iptcData.add(md);
+        }
+        Exiv2::XmpData xmpData;
+        for (auto&& md : image->xmpData()) {
+            if (grepTag(md.key()) && keyTag(md.key())) xmpData.add(md);
+        }
+        writer.write(exifData, iptcData, xmpData, path);
+        return 0;
+    } // Print::printJson
+
     int Print::printMetadata(const Exiv2::Image* image)
     {
         bool ret = false;
@@ -989,7 +1040,7 @@ namespace Action {
             if (num == 0) {
                 // Write all previews
                 for (num = 0; num < pvList.size(); ++num) {
-                    writePreviewFile(pvMgr.getPreviewImage(pvList[num]), static_cast<int>(num + 1));
+                    writePreviewFile(pvMgr, pvList[num], static_cast<int>(num + 1));
                 }
                 break;
             }
@@ -999,7 +1050,7 @@ namespace Action {
                           << " " << num + 1 << "\n";
                 continue;
             }
-            writePreviewFile(pvMgr.getPreviewImage(pvList[num]), static_cast<int>(num + 1));
+            writePreviewFile(pvMgr, pvList[num], static_cast<int>(num + 1));
         }
         return 0;
     } // Extract::writePreviews
@@ -1042,22 +1093,27 @@ namespace Action {
     } // Extract::writeIccProfile
 
 
-    void Extract::writePreviewFile(const Exiv2::PreviewImage& pvImg, int num) const
+    void Extract::writePreviewFile(const Exiv2::PreviewManager& pvMgr,
+                                   const Exiv2::PreviewProperties& pvProps, int num) const
     {
         std::string pvFile = newFilePath(path_, "-preview") + Exiv2::toString(num);
-        std::string pvPath = pvFile + pvImg.extension();
+        std::string pvPath = pvFile + pvProps.extension_;
         if (dontOverwrite(pvPath)) return;
         if (Params::instance().verbose_) {
             std::cout << _("Writing preview") << " " << num << " ("
-                      << pvImg.mimeType() << ", ";
-            if (pvImg.width() != 0 && pvImg.height() != 0) {
-                std::cout << pvImg.width() << "x" << pvImg.height() << " "
+                      << pvProps.mimeType_ << ", ";
+            if (pvProps.width_ != 0 && pvProps.height_ != 0) {
+                std::cout << pvProps.width_ << "x" << pvProps.height_ << " "
                           << _("pixels") << ", ";
             }
-            std::cout << pvImg.size() << " " << _("bytes") << ") "
+            std::cout << pvProps.size_ << " " << _("bytes") << ") "
                       << _("to file") << " " << pvPath << std::endl;
         }
-        long rc = pvImg.writeFile(pvFile);
+        Exiv2::FileIo pvIo(pvPath);
+        if (pvIo.open("wb") != 0) {
+            throw Exiv2::Error(Exiv2::kerFileOpenFailed, pvPath, "wb", Exiv2::strError());
+        }
+        long rc = pvMgr.copyPreview(pvProps, pvIo);
         if (rc == 0) {
             std::cerr << path_ << ": " << _("Image does not have preview")
                       << " " << num << "\n";
@@ -1267,7 +1323,7 @@ namespace Action {
         assert(image.get() != 0);
         image->readMetadata();
 
-        int rc = applyCommands(image.get());
+        int rc = applyCommands(image.get(), *out_);
 
         // Save both exif and iptc metadata
         image->writeMetadata();
@@ -1284,14 +1340,14 @@ namespace Action {
     }
     } // Modify::run
 
-    int Modify::applyCommands(Exiv2::Image* pImage)
+    int Modify::applyCommands(Exiv2::Image* pImage, std::ostream& out)
     {
         if (!Params::instance().jpegComment_.empty()) {
             if (Params::instance().verbose_) {
-                std::cout << _("Setting JPEG comment") << " '"
-                          << Params::instance().jpegComment_
-                          << "'"
-                          << std::endl;
+                out << _("Setting JPEG comment") << " '"
+                    << Params::instance().jpegComment_
+                    << "'"
+                    << std::endl;
             }
             pImage->setComment(Params::instance().jpegComment_);
         }
@@ -1303,20 +1359,23 @@ namespace Action {
         for (auto&& cmd : modifyCmds) {
             switch (cmd.cmdId_) {
                 case add:
-                    ret = addMetadatum(pImage, cmd);
+                    ret = addMetadatum(pImage, cmd, out);
                     if (rc == 0)
                         rc = ret;
                     break;
                 case set:
-                    ret = setMetadatum(pImage, cmd);
+                    ret = setMetadatum(pImage, cmd, out);
                     if (rc == 0)
                         rc = ret;
                     break;
                 case del:
-                    delMetadatum(pImage, cmd);
+                    delMetadatum(pImage, cmd, out);
                     break;
                 case reg:
-                    regNamespace(cmd);
+                    // Decode XMP read from the image (which may register
+                    // namespaces) before the registration is changed
+                    pImage->xmpData().empty();
+                    regNamespace(cmd, out);
                     break;
                 case invalidCmdId:
                     assert(invalidCmdId == cmd.cmdId_);
@@ -1326,13 +1385,13 @@ namespace Action {
         return rc;
     } // Modify::applyCommands
 
-    int Modify::addMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd)
+    int Modify::addMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd, std::ostream& out)
     {
         if (Params::instance().verbose_) {
-            std::cout << _("Add") << " " << modifyCmd.key_ << " \""
-                      << modifyCmd.value_ << "\" ("
-                      << Exiv2::TypeInfo::typeName(modifyCmd.typeId_)
-                      << ")" << std::endl;
+            out << _("Add") << " " << modifyCmd.key_ << " \""
+                << modifyCmd.value_ << "\" ("
+                << Exiv2::TypeInfo::typeName(modifyCmd.typeId_)
+                << ")" << std::endl;
         }
         Exiv2::ExifData& exifData = pImage->exifData();
         Exiv2::IptcData& iptcData = pImage->iptcData();
@@ -1362,13 +1421,13 @@ namespace Action {
 
     // This function looks rather complex because we try to avoid adding an
     // empty metadatum if reading the value fails
-    int Modify::setMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd)
+    int Modify::setMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd, std::ostream& out)
     {
         if (Params::instance().verbose_) {
-            std::cout << _("Set") << " " << modifyCmd.key_ << " \""
-                      << modifyCmd.value_ << "\" ("
-                      << Exiv2::TypeInfo::typeName(modifyCmd.typeId_)
-                      << ")" << std::endl;
+            out << _("Set") << " " << modifyCmd.key_ << " \""
+                << modifyCmd.value_ << "\" ("
+                << Exiv2::TypeInfo::typeName(modifyCmd.typeId_)
+                << ")" << std::endl;
         }
         Exiv2::ExifData& exifData = pImage->exifData();
         Exiv2::IptcData& iptcData = pImage->iptcData();
@@ -1429,10 +1488,10 @@ namespace Action {
         return rc;
     }
 
-    void Modify::delMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd)
+    void Modify::delMetadatum(Exiv2::Image* pImage, const ModifyCmd& modifyCmd, std::ostream& out)
     {
         if (Params::instance().verbose_) {
-            std::cout << _("Del") << " " << modifyCmd.key_ << std::endl;
+            out << _("Del") << " " << modifyCmd.key_ << std::endl;
         }
 
         Exiv2::ExifData& exifData = pImage->exifData();
@@ -1461,11 +1520,11 @@ namespace Action {
         }
     }
 
-    void Modify::regNamespace(const ModifyCmd& modifyCmd)
+    void Modify::regNamespace(const ModifyCmd& modifyCmd, std::ostream& out)
     {
         if (Params::instance().verbose_) {
-            std::cout << _("Reg ") << modifyCmd.key_ << "=\""
-                      << modifyCmd.value_ << "\"" << std::endl;
+            out << _("Reg ") << modifyCmd.key_ << "=\""
+                << modifyCmd.value_ << "\"" << std::endl;
         }
         Exiv2::XmpProperties::registerNs(modifyCmd.value_, modifyCmd.key_);
     }
@@ -1896,6 +1955,9 @@ namespace {
 
         // Apply any modification commands to the source image on-the-fly
         Action::Modify::applyCommands(sourceImage.get());
+        // Decode the source XMP before the target's, namespaces found in the
+        // target take precedence
+        sourceImage->xmpData().empty();
 
         // Open or create the target file
         std::string target(bStdout ? temporaryPath() : tgt);
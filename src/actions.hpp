@@ -174,6 +174,10 @@ namespace Action {
         int printSummary();
         //! Print Exif, IPTC and XMP metadata in user defined format
         int printList();
+        //! Print Exif, IPTC and XMP metadata as JSON, one object per file
+        int printJson(bool ndjson);
+        //! Print the information requested by the print mode for one file
+        int runMode(const std::string& path);
         //! Return true if key should be printed, else false
         static bool grepTag(const std::string& key);
         //! Return true if key should be printed, else false
@@ -209,6 +213,8 @@ namespace Action {
 
         std::string path_;
         int align_{0};                // for the alignment of the summary output
+        std::shared_ptr<Exiv2::JsonWriter> jsonWriter_; // for all files printed as JSON
+        size_t jsonFiles_{0};         // number of files printed as JSON
     }; // class Print
 
     /*!
@@ -314,8 +320,11 @@ namespace Action {
                  removing the suffix from the image filename and appending
                  "-preview<num>" and the appropriate suffix (".jpg" or ".tif"),
                  depending on the format of the Exif thumbnail image.
+                 The preview image is copied from the image file if it is
+                 stored there as it is.
          */
-        void writePreviewFile(const Exiv2::PreviewImage& pvImg, int num) const;
+        void writePreviewFile(const Exiv2::PreviewManager& pvMgr,
+                              const Exiv2::PreviewProperties& pvProps, int num) const;
         /*!
           @brief Write embedded iccProfile files.
          */
@@ -378,8 +387,13 @@ namespace Action {
         using UniquePtr = std::unique_ptr<Modify>;
         UniquePtr clone() const;
         Modify() {}
-        //! Apply modification commands to the \em pImage, return 0 if successful.
-        static int applyCommands(Exiv2::Image* pImage);
+        //! Write the verbose messages of run() to \em out instead of std::cout
+        void setOutput(std::ostream& out) { out_ = &out; }
+        /*!
+          @brief Apply modification commands to the \em pImage, return 0 if successful.
+                 Verbose messages are written to \em out.
+         */
+        static int applyCommands(Exiv2::Image* pImage, std::ostream& out = std::cout);
 
     private:
         Modify* clone_() const override;
@@ -388,15 +402,22 @@ namespace Action {
 
         //! Add a metadatum to \em pImage according to \em modifyCmd
         static int addMetadatum(Exiv2::Image* pImage,
-                                const ModifyCmd& modifyCmd);
+                                const ModifyCmd& modifyCmd,
+                                std::ostream& out);
         //! Set a metadatum in \em pImage according to \em modifyCmd
         static int setMetadatum(Exiv2::Image* pImage,
-                                const ModifyCmd& modifyCmd);
+                                const ModifyCmd& modifyCmd,
+                                std::ostream& out);
         //! Delete a metadatum from \em pImage according to \em modifyCmd
         static void delMetadatum(Exiv2::Image* pImage,
-                                 const ModifyCmd& modifyCmd);
+                                 const ModifyCmd& modifyCmd,
+                                 std::ostream& out);
         //! Register an XMP namespace according to \em modifyCmd
-        static void regNamespace(const ModifyCmd& modifyCmd);
+        static void regNamespace(const ModifyCmd& modifyCmd,
+                                 std::ostream& out);
+
+        //! Stream for the verbose messages
+        std::ostream* out_{&std::cout};
 
     }; // class Modify
 
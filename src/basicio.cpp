@@ -31,12 +31,17 @@
 #include "http.hpp"
 #include "properties.hpp"
 #include "image_int.hpp"
+#include "blockcache_int.hpp"
 
 // + standard includes
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <memory>
+#include <vector>
 #include <iostream>
 #include <cstring>                      // std::memcpy
+#include <cerrno>
 #include <cassert>
 #include <fstream>                      // write the temporary file
 #include <fcntl.h>                      // _O_BINARY in FileIo::FileIo
@@ -55,6 +60,9 @@
 #ifdef EXV_HAVE_UNISTD_H
 # include <unistd.h>                    // for getpid, stat
 #endif
+#ifdef EXV_HAVE_SENDFILE
+# include <sys/sendfile.h>              // for sendfile
+#endif
 
 #ifdef EXV_USE_CURL
 # include <curl/curl.h>
@@ -74,6 +82,125 @@ using nlink_t = short;
 # include <io.h>
 #endif
 
+#if defined(EXV_HAVE_UNISTD_H) && !defined(_WIN32) && !defined(EXV_UNICODE_PATH)
+# define EXV_ATOMIC_WRITE 1
+#endif
+
+// *****************************************************************************
+// local declarations
+namespace {
+    //! Temporary file which replaces the file \em target when its write batch is committed
+    struct PendingFile {
+        std::string temp;                       //!< Path of the temporary file
+        std::string target;                     //!< Path of the file to replace
+    };
+
+    //! Pending files of the innermost WriteBatch of the thread, nullptr if there is none
+    thread_local std::vector<PendingFile>* pendingFiles = nullptr;
+
+#ifdef EXV_ATOMIC_WRITE
+    //! Return the directory of \em path
+    std::string dirName(const std::string& path)
+    {
+        const auto pos = path.rfind('/');
+        if (pos == std::string::npos) return ".";
+        return pos == 0 ? "/" : path.substr(0, pos);
+    }
+
+    /*!
+      @brief Sync the files or directories \em paths to disk. With \em group,
+          each file system is synced only once where the platform allows it.
+     */
+    void syncPaths(const std::vector<std::string>& paths, bool group)
+    {
+#ifdef EXV_HAVE_SYNCFS
+        std::vector<dev_t> devices;
+#else
+        (void)group;
+#endif
+        for (auto&& path : paths) {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw Exiv2::Error(Exiv2::kerCallFailed, path, Exiv2::strError(), "open");
+            int rc = 0;
+            const char* function = "fsync";
+            bool synced = false;
+#ifdef EXV_HAVE_SYNCFS
+            struct stat buf;
+            if (group && ::fstat(fd, &buf) == 0) {
+                function = "syncfs";
+                synced = true;
+                if (std::find(devices.begin(), devices.end(), buf.st_dev) == devices.end()) {
+                    devices.push_back(buf.st_dev);
+                    rc = ::syncfs(fd);
+                }
+            }
+#endif
+            if (!synced) rc = ::fsync(fd);
+            // Some file systems cannot sync directories
+            if (rc != 0 && errno == EINVAL) rc = 0;
+            const std::string error = rc != 0 ? Exiv2::strError() : "";
+            ::close(fd);
+            if (rc != 0) throw Exiv2::Error(Exiv2::kerCallFailed, path, error, function);
+        }
+    }
+
+    /*!
+      @brief Write the contents of \em src to a new temporary file in the
+          directory of the file \em target, with the permissions and, if
+          possible, the owner of \em target. If \em src is a FileIo on the
+          same file system, its file is renamed instead.
+      @return The path of the temporary file
+     */
+    std::string writeTemporary(const std::string& target, Exiv2::BasicIo& src)
+    {
+        struct stat buf;
+        const bool exists = ::stat(target.c_str(), &buf) == 0;
+        std::string temp;
+        int fd = -1;
+        for (int i = 0; fd < 0; i++) {
+            temp = target + ".exiv2_" + std::to_string(::getpid()) + "_" + std::to_string(i);
+            fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, exists ? 0600 : 0666);
+            if (fd < 0 && (errno != EEXIST || i == 99)) {
+                throw Exiv2::Error(Exiv2::kerFileOpenFailed, temp, "wb", Exiv2::strError());
+            }
+        }
+        ::close(fd);
+
+        try {
+            auto fileIo = dynamic_cast<Exiv2::FileIo*>(&src);
+            if (fileIo) fileIo->close();
+            if (!fileIo || ::rename(fileIo->path().c_str(), temp.c_str()) != 0) {
+                Exiv2::FileIo tempIo(temp);
+                if (tempIo.open("wb") != 0) {
+                    throw Exiv2::Error(Exiv2::kerFileOpenFailed, temp, "wb", Exiv2::strError());
+                }
+                if (src.open() != 0) {
+                    throw Exiv2::Error(Exiv2::kerDataSourceOpenFailed, src.path(), Exiv2::strError());
+                }
+                const size_t size = src.size();
+                if (static_cast<size_t>(tempIo.write(src)) != size || tempIo.error() || src.error()) {
+                    throw Exiv2::Error(Exiv2::kerTransferFailed, target, Exiv2::strError());
+                }
+                src.close();
+            }
+            if (exists) {
+                if (::chown(temp.c_str(), buf.st_uid, buf.st_gid) != 0) {
+                    // Only the owner of the file or root can keep the owner
+                }
+                if (::chmod(temp.c_str(), buf.st_mode & 07777) != 0) {
+                    throw Exiv2::Error(Exiv2::kerCallFailed, temp, Exiv2::strError(), "::chmod");
+                }
+            }
+        }
+        catch (...) {
+            ::remove(temp.c_str());
+            throw;
+        }
+        return temp;
+    }
+#endif
+}
+
 // *****************************************************************************
 // class member definitions
 namespace Exiv2 {
@@ -111,6 +238,7 @@ namespace Exiv2 {
         size_t mappedLength_;           //!< Size of the memory-mapped area
         bool   isMalloced_;             //!< Is the mapped area allocated?
         bool   isWriteable_;            //!< Can the mapped area be written to?
+        bool   atomicWrite_;            //!< Does transfer() replace the file atomically?
         // TYPES
         //! Simple struct stat wrapper for internal use
         struct StructStat {
@@ -132,6 +260,19 @@ namespace Exiv2 {
         int stat(StructStat& buf) const;
         //! copy extended attributes (xattr) from another file
         void copyXattrFrom(const FileIo& src);
+        /*!
+          @brief Replace the file, or the file a symlink points to, atomically
+              with the contents of \em src, or prepare this in the active
+              WriteBatch.
+         */
+        void replaceAtomically(BasicIo& src);
+        /*!
+          @brief Let the kernel copy the rest of the file \em src, at most
+              \em limit bytes, to the current position of this file, where
+              supported. Both streams are positioned after the copied data.
+          @return Number of bytes copied, may be less than requested
+         */
+        long copyFrom(Impl& src, size_t limit);
 #if defined WIN32 && !defined __CYGWIN__
         // Windows function to determine the number of hardlinks (on NTFS)
         DWORD winNumberOfLinks() const;
@@ -155,7 +296,8 @@ namespace Exiv2 {
           pMappedArea_(nullptr),
           mappedLength_(0),
           isMalloced_(false),
-          isWriteable_(false)
+          isWriteable_(false),
+          atomicWrite_(getEnv(envATOMICWRITE) == "1")
     {
     }
 
@@ -167,7 +309,8 @@ namespace Exiv2 {
 #if defined WIN32 && !defined __CYGWIN__
           hFile_(0), hMap_(0),
 #endif
-          pMappedArea_(0), mappedLength_(0), isMalloced_(false), isWriteable_(false)
+          pMappedArea_(0), mappedLength_(0), isMalloced_(false), isWriteable_(false),
+          atomicWrite_(getEnv(envATOMICWRITE) == "1")
     {
     }
 
@@ -315,6 +458,81 @@ namespace Exiv2 {
 #endif
     } // FileIo::Impl::copyXattrFrom
 
+    void FileIo::Impl::replaceAtomically(BasicIo& src)
+    {
+#ifdef EXV_ATOMIC_WRITE
+        std::string target(path_);
+        char* realPath = ::realpath(path_.c_str(), nullptr);
+        if (realPath) {
+            target = realPath;
+            std::free(realPath);
+        }
+        const std::string temp = writeTemporary(target, src);
+        if (pendingFiles) {
+            pendingFiles->push_back({temp, target});
+            return;
+        }
+        try {
+            syncPaths({temp}, false);
+            if (::rename(temp.c_str(), target.c_str()) != 0) {
+                throw Error(kerFileRenameFailed, temp, target, strError());
+            }
+        }
+        catch (...) {
+            ::remove(temp.c_str());
+            throw;
+        }
+        syncPaths({dirName(target)}, false);
+#else
+        (void)src;
+#endif
+    } // FileIo::Impl::replaceAtomically
+
+    long FileIo::Impl::copyFrom(Impl& src, size_t limit)
+    {
+        long total = 0;
+#if defined(EXV_HAVE_COPY_FILE_RANGE) || defined(EXV_HAVE_SENDFILE)
+        // Writes to a file in append mode always go to its end
+        if (openMode_.at(0) == 'a') return 0;
+        if (src.switchMode(opRead) != 0 || std::fflush(fp_) != 0) return 0;
+        const int in = ::fileno(src.fp_);
+        const int out = ::fileno(fp_);
+        off_t inOffset = ::ftello(src.fp_);
+        off_t outOffset = ::ftello(fp_);
+        struct stat buf;
+        if (inOffset < 0 || outOffset < 0 || ::fstat(in, &buf) != 0 || buf.st_size <= inOffset) return 0;
+        auto count = std::min(static_cast<size_t>(buf.st_size - inOffset), limit);
+#ifdef EXV_HAVE_COPY_FILE_RANGE
+        while (count > 0) {
+            const ssize_t n = ::copy_file_range(in, &inOffset, out, &outOffset, count, 0);
+            if (n <= 0) break;
+            count -= n;
+            total += n;
+        }
+#endif
+#ifdef EXV_HAVE_SENDFILE
+        // Fallback, e.g. across file systems on older kernels. sendfile
+        // writes at the file offset of out
+        if (count > 0 && ::lseek(out, outOffset, SEEK_SET) == outOffset) {
+            while (count > 0) {
+                const ssize_t n = ::sendfile(out, in, &inOffset, count);
+                if (n <= 0) break;
+                count -= n;
+                total += n;
+                outOffset += n;
+            }
+        }
+#endif
+        // The streams continue where the kernel stopped
+        ::fseeko(src.fp_, inOffset, SEEK_SET);
+        ::fseeko(fp_, outOffset, SEEK_SET);
+#else
+        (void)src;
+        (void)limit;
+#endif
+        return total;
+    } // FileIo::Impl::copyFrom
+
 #if defined WIN32 && !defined __CYGWIN__
     DWORD FileIo::Impl::winNumberOfLinks() const
     {
@@ -571,6 +789,11 @@ namespace Exiv2 {
     }
 #endif
 
+    void FileIo::setAtomicWrite(bool atomic)
+    {
+        p_->atomicWrite_ = atomic;
+    }
+
     long FileIo::write(const byte* data, long wcount)
     {
         assert(p_->fp_ != 0);
@@ -579,18 +802,41 @@ namespace Exiv2 {
     }
 
     long FileIo::write(BasicIo& src)
+    {
+        return write(src, std::numeric_limits<long>::max());
+    }
+
+    long FileIo::write(BasicIo& src, long count)
     {
         assert(p_->fp_ != 0);
         if (static_cast<BasicIo*>(this) == &src) return 0;
-        if (!src.isopen()) return 0;
+        if (!src.isopen() || count <= 0) return 0;
         if (p_->switchMode(Impl::opWrite) != 0) return 0;
 
-        byte buf[4096];
+        // A MemIo holds all its data, write the requested part at once
+        auto memIo = dynamic_cast<MemIo*>(&src);
+        if (memIo) {
+            const long pos = memIo->tell();
+            count = std::min(count, static_cast<long>(memIo->size()) - pos);
+            if (count <= 0) return 0;
+            const auto writeCount = static_cast<long>(std::fwrite(memIo->mmap() + pos, 1, count, p_->fp_));
+            memIo->seek(writeCount, BasicIo::cur);
+            return writeCount;
+        }
+
+        long writeTotal = 0;
+        auto fileIo = dynamic_cast<FileIo*>(&src);
+        if (fileIo) {
+            writeTotal = p_->copyFrom(*fileIo->p_, static_cast<size_t>(count));
+        }
+
+        // Copy what is left through a buffer
+        DataBuf buf(static_cast<long>(std::min(static_cast<size_t>(count - writeTotal), Internal::copyIoBufferSize)));
         long readCount = 0;
         long writeCount = 0;
-        long writeTotal = 0;
-        while ((readCount = src.read(buf, sizeof(buf)))) {
-            writeTotal += writeCount = static_cast<long>(std::fwrite(buf, 1, readCount, p_->fp_));
+        while (writeTotal < count
+               && (readCount = src.read(buf.data(), std::min(buf.size(), count - writeTotal)))) {
+            writeTotal += writeCount = static_cast<long>(std::fwrite(buf.c_data(), 1, readCount, p_->fp_));
             if (writeCount != readCount) {
                 // try to reset back to where write stopped
                 src.seek(writeCount-readCount, BasicIo::cur);
@@ -607,6 +853,13 @@ namespace Exiv2 {
         const std::string lastMode(p_->openMode_);
 
         auto fileIo = dynamic_cast<FileIo*>(&src);
+#ifdef EXV_ATOMIC_WRITE
+        if (p_->atomicWrite_ || pendingFiles) {
+            close();
+            p_->replaceAtomically(src);
+        }
+        else
+#endif
         if (fileIo) {
             // Optimization if src is another instance of FileIo
             fileIo->close();
@@ -1024,6 +1277,15 @@ namespace Exiv2 {
         return std::feof(p_->fp_) != 0;
     }
 
+    bool FileIo::atomicWrite() const
+    {
+#ifdef EXV_ATOMIC_WRITE
+        return p_->atomicWrite_;
+#else
+        return false;
+#endif
+    }
+
     std::string FileIo::path() const
     {
 #ifdef EXV_UNICODE_PATH
@@ -1049,6 +1311,79 @@ namespace Exiv2 {
 
     }
 
+    void FileIo::prefetch(long offset, long size)
+    {
+#ifdef EXV_HAVE_POSIX_FADVISE
+        if (p_->fp_ != nullptr && offset >= 0 && size > 0) {
+            ::posix_fadvise(fileno(p_->fp_), offset, size, POSIX_FADV_WILLNEED);
+        }
+#else
+        (void)offset;
+        (void)size;
+#endif
+    }
+
+    //! Internal Pimpl structure of class WriteBatch.
+    class WriteBatch::Impl {
+    public:
+        // DATA
+        std::vector<PendingFile> files_;        //!< Pending replacements, in the order of the transfers
+        std::vector<PendingFile>* previous_{nullptr}; //!< Pending files of the enclosing batch
+    }; // class WriteBatch::Impl
+
+    WriteBatch::WriteBatch() : p_(new Impl())
+    {
+        p_->previous_ = pendingFiles;
+        pendingFiles = &p_->files_;
+    }
+
+    WriteBatch::~WriteBatch()
+    {
+        for (auto&& file : p_->files_) {
+            ::remove(file.temp.c_str());
+        }
+        pendingFiles = p_->previous_;
+    }
+
+    void WriteBatch::commit()
+    {
+#ifdef EXV_ATOMIC_WRITE
+        auto& files = p_->files_;
+        if (files.empty()) return;
+        std::vector<std::string> paths;
+        paths.reserve(files.size());
+        for (auto&& file : files) {
+            paths.push_back(file.temp);
+        }
+        syncPaths(paths, true);
+
+        // The renamed files stay renamed if one fails, their directories are synced in any case
+        std::vector<std::string> dirs;
+        std::string error;
+        size_t renamed = 0;
+        for (; renamed < files.size(); renamed++) {
+            const PendingFile& file = files[renamed];
+            if (::rename(file.temp.c_str(), file.target.c_str()) != 0) {
+                error = strError();
+                break;
+            }
+            const std::string dir = dirName(file.target);
+            if (std::find(dirs.begin(), dirs.end(), dir) == dirs.end()) dirs.push_back(dir);
+        }
+        const PendingFile failed = renamed < files.size() ? files[renamed] : PendingFile();
+        files.erase(files.begin(), files.begin() + renamed);
+        syncPaths(dirs, true);
+        if (!error.empty()) {
+            throw Error(kerFileRenameFailed, failed.temp, failed.target, error);
+        }
+#endif
+    } // WriteBatch::commit
+
+    size_t WriteBatch::size() const
+    {
+        return p_->files_.size();
+    }
+
     //! Internal Pimpl structure of class MemIo.
     class MemIo::Impl final{
     public:
@@ -1118,6 +1453,12 @@ namespace Exiv2 {
             size_ = num;
         }
 
+        //! @brief Change the status of a bKnown block back to bNone, so that its data is read.
+        void    markNone()
+        {
+            if (type_ == bKnown) type_ = bNone;
+        }
+
         bool    isNone() const
         {
             return type_ == bNone;
@@ -1244,11 +1585,11 @@ namespace Exiv2 {
         if (static_cast<BasicIo*>(this) == &src) return 0;
         if (!src.isopen()) return 0;
 
-        byte buf[4096];
+        DataBuf buf(static_cast<long>(Internal::copyIoBufferSize));
         long readCount = 0;
         long writeTotal = 0;
-        while ((readCount = src.read(buf, sizeof(buf)))) {
-            write(buf, readCount);
+        while ((readCount = src.read(buf.data(), buf.size()))) {
+            write(buf.c_data(), readCount);
             writeTotal += readCount;
         }
 
@@ -1587,6 +1928,13 @@ namespace Exiv2 {
         bool            eof_;           //!< EOF indicator
         Protocol        protocol_;      //!< the protocol of url
         uint32_t        totalRead_;     //!< bytes requested from host
+        size_t          readAhead_{0};  //!< Number of blocks fetched ahead of a sequential read
+        size_t          nextBlock_{0};  //!< Block after the last fetch, where a sequential read continues
+        std::vector<std::pair<long, long> > prefetch_; //!< Ranges of blocks to fetch with the next fetch
+        std::string     validator_;     //!< ETag or Last-Modified of the remote file, if known
+        std::unique_ptr<Internal::BlockCache> cache_; //!< Persistent block cache, if enabled
+        uint64_t        cacheKey_{0};   //!< Key of the remote file in the block cache
+        std::vector<bool> mapped_;      //!< Blocks which have been copied to the mapped area
 
         // METHODS
         /*!
@@ -1604,6 +1952,15 @@ namespace Exiv2 {
           @note Set lowBlock = -1 and highBlock = -1 to get the whole file content.
          */
         virtual void getDataByRange(long lowBlock, long highBlock, std::string& response) = 0;
+        /*!
+          @brief Get the data of several ranges of blocks.
+          @param ranges The start and end block index of each range.
+          @param responses The data from the server, one for each range.
+          @throw Error if the server returns the error code.
+          @note The default implementation calls getDataByRange() for each range.
+         */
+        virtual void getDataByRanges(const std::vector<std::pair<long, long> >& ranges,
+                                     std::vector<std::string>& responses);
         /*!
           @brief Submit the data to the remote machine. The data replace a part of the remote file.
                 The replaced part of remote file is indicated by from and to parameters.
@@ -1624,6 +1981,40 @@ namespace Exiv2 {
           @throw Error if it fails.
          */
         virtual size_t populateBlocks(size_t lowBlock, size_t highBlock);
+        /*!
+          @brief Get the missing blocks of ranges and of all prefetched ranges from the remote
+                machine in one batch, and write them to the memory blocks.
+          @param ranges The start and end block index of each range, sorted or not.
+          @return Number of bytes written to the memory block successfully
+          @throw Error if it fails.
+         */
+        size_t populateRanges(std::vector<std::pair<long, long> > ranges);
+        /*!
+          @brief Populate the blocks needed by a read, and grow or reset the readahead. While the
+                file is read sequentially, the number of blocks fetched ahead doubles with each
+                fetch, up to maxReadAhead bytes. The first read at the start of the file fetches
+                initialReadAhead bytes, which hold the metadata of most files.
+          @param lowBlock The start block index.
+          @param highBlock The end block index.
+          @throw Error if it fails.
+         */
+        void readBlocks(size_t lowBlock, size_t highBlock);
+        //! Append the ranges of missing blocks from lowBlock to highBlock to ranges
+        void missingBlocks(size_t lowBlock, size_t highBlock, std::vector<std::pair<long, long> >& ranges) const;
+        /*!
+          @brief Open the persistent block cache if the environment variable EXIV2_REMOTE_CACHE
+                names its directory and the validator of the remote file is known.
+         */
+        void openCache();
+        //! Populate the missing blocks of ranges which are in the block cache, return true if any
+        bool readCache(const std::vector<std::pair<long, long> >& ranges);
+        //! Copy the blocks from lowBlock to highBlock which have been read to the mapped area
+        void mapBlocks(byte* map, size_t lowBlock, size_t highBlock);
+
+        //! Readahead in bytes of the first read at the start of the file
+        static const size_t initialReadAhead = 64 * 1024;
+        //! Upper limit of the readahead in bytes
+        static const size_t maxReadAhead = 256 * 1024;
 
     }; // class RemoteIo::Impl
 
@@ -1647,30 +2038,85 @@ namespace Exiv2 {
     }
 #endif
 
+    void RemoteIo::Impl::getDataByRanges(const std::vector<std::pair<long, long> >& ranges,
+                                         std::vector<std::string>& responses)
+    {
+        responses.resize(ranges.size());
+        for (size_t i = 0; i < ranges.size(); i++) {
+            getDataByRange(ranges[i].first, ranges[i].second, responses[i]);
+        }
+    }
+
+    void RemoteIo::Impl::missingBlocks(size_t lowBlock, size_t highBlock,
+                                       std::vector<std::pair<long, long> >& ranges) const
+    {
+        for (size_t iBlock = lowBlock; iBlock <= highBlock; iBlock++) {
+            if (!blocksMap_[iBlock].isNone()) continue;
+            if (!ranges.empty() && ranges.back().second == static_cast<long>(iBlock) - 1) {
+                ranges.back().second = static_cast<long>(iBlock);
+            } else {
+                ranges.emplace_back(static_cast<long>(iBlock), static_cast<long>(iBlock));
+            }
+        }
+    }
+
     size_t RemoteIo::Impl::populateBlocks(size_t lowBlock, size_t highBlock)
+    {
+        assert(isMalloced_);
+        std::vector<std::pair<long, long> > ranges;
+        missingBlocks(lowBlock, highBlock, ranges);
+        return populateRanges(ranges);
+    }
+
+    size_t RemoteIo::Impl::populateRanges(std::vector<std::pair<long, long> > ranges)
     {
         assert(isMalloced_);
 
-        // optimize: ignore all true blocks on left & right sides.
-        while(!blocksMap_[lowBlock].isNone()  && lowBlock  < highBlock) lowBlock++;
-        while(!blocksMap_[highBlock].isNone() && highBlock > lowBlock)  highBlock--;
+        // coalesce adjacent missing blocks into ranges and request them together
+        // with the ranges which were prefetched
+        for (auto&& range : prefetch_) {
+            missingBlocks(range.first, range.second, ranges);
+        }
+        prefetch_.clear();
+        if (ranges.empty()) return 0;
+        std::sort(ranges.begin(), ranges.end());
+        size_t n = 0;
+        for (size_t i = 1; i < ranges.size(); i++) {
+            if (ranges[i].first <= ranges[n].second + 1) {
+                ranges[n].second = std::max(ranges[n].second, ranges[i].second);
+            } else {
+                ranges[++n] = ranges[i];
+            }
+        }
+        ranges.resize(n + 1);
+        if (cache_ && readCache(ranges)) {
+            std::vector<std::pair<long, long> > missing;
+            for (auto&& range : ranges) {
+                missingBlocks(range.first, range.second, missing);
+            }
+            ranges.swap(missing);
+            if (ranges.empty()) return 0;
+        }
 
+        std::vector<std::string> data;
+        getDataByRanges(ranges, data);
         size_t rcount = 0;
-        if (blocksMap_[highBlock].isNone())
-        {
-            std::string data;
-            getDataByRange(static_cast<long>(lowBlock), static_cast<long>(highBlock), data);
-            rcount = data.length();
-            if (rcount == 0) {
+        for (size_t i = 0; i < ranges.size(); i++) {
+            if (data[i].empty()) {
                 throw Error(kerErrorMessage, "Data By Range is empty. Please check the permission.");
             }
-            auto source = reinterpret_cast<byte*>(const_cast<char*>(data.c_str()));
-            size_t remain = rcount, totalRead = 0;
-            size_t iBlock = (rcount == size_) ? 0 : lowBlock;
+            rcount += data[i].length();
+            auto source = reinterpret_cast<byte*>(&data[i][0]);
+            size_t remain = data[i].length(), totalRead = 0;
+            // the server may send the whole file instead of the range
+            size_t iBlock = (remain == size_) ? 0 : ranges[i].first;
 
             while (remain) {
                 size_t allow = std::min(remain, blockSize_);
-                blocksMap_[iBlock].populate(&source[totalRead], allow);
+                if (blocksMap_[iBlock].isNone()) {
+                    blocksMap_[iBlock].populate(&source[totalRead], allow);
+                    if (cache_) cache_->put(cacheKey_, iBlock, &source[totalRead], allow);
+                }
                 remain -= allow;
                 totalRead += allow;
                 iBlock++;
@@ -1680,6 +2126,76 @@ namespace Exiv2 {
         return rcount;
     }
 
+    void RemoteIo::Impl::openCache()
+    {
+        cache_.reset();
+        const std::string dir = getEnv(envREMOTECACHE);
+        if (dir.empty() || validator_.empty()) return;
+        const long megabytes = std::max(atol(getEnv(envREMOTECACHESIZE).c_str()), 1L);
+        cache_.reset(new Internal::BlockCache(dir, blockSize_, static_cast<size_t>(megabytes) * 1024 * 1024));
+        if (!cache_->good()) {
+            cache_.reset();
+            return;
+        }
+        cacheKey_ = Internal::BlockCache::fileKey(path_, validator_, size_);
+    }
+
+    bool RemoteIo::Impl::readCache(const std::vector<std::pair<long, long> >& ranges)
+    {
+        const size_t nBlocks = (size_ + blockSize_ - 1) / blockSize_;
+        std::vector<byte> buf(blockSize_);
+        bool found = false;
+        for (auto&& range : ranges) {
+            for (long iBlock = range.first; iBlock <= range.second; iBlock++) {
+                if (!blocksMap_[iBlock].isNone()) continue;
+                // only the last block of the file may be short
+                const size_t size = static_cast<size_t>(iBlock) + 1 < nBlocks ? blockSize_ : size_ - iBlock * blockSize_;
+                if (cache_->get(cacheKey_, iBlock, buf.data()) == size) {
+                    blocksMap_[iBlock].populate(buf.data(), size);
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+
+    void RemoteIo::Impl::mapBlocks(byte* map, size_t lowBlock, size_t highBlock)
+    {
+        for (size_t iBlock = lowBlock; iBlock <= highBlock; iBlock++) {
+            const BlockMap& block = blocksMap_[iBlock];
+            if (mapped_[iBlock] || block.isNone()) continue;
+            // known blocks are fake data
+            if (block.isInMem()) {
+                std::memcpy(map + iBlock * blockSize_, block.getData(), block.getSize());
+            } else {
+                std::memset(map + iBlock * blockSize_, 0, block.getSize());
+            }
+            mapped_[iBlock] = true;
+        }
+    }
+
+    void RemoteIo::Impl::readBlocks(size_t lowBlock, size_t highBlock)
+    {
+        const size_t nBlocks = (size_ + blockSize_ - 1) / blockSize_;
+        highBlock = std::min(highBlock, nBlocks - 1);
+
+        size_t iBlock = lowBlock;
+        while (iBlock <= highBlock && !blocksMap_[iBlock].isNone()) iBlock++;
+        if (iBlock > highBlock) return;
+
+        if (iBlock == 0 && nextBlock_ == 0) {
+            readAhead_ = std::max(initialReadAhead / blockSize_, static_cast<size_t>(1));
+        } else if (iBlock == nextBlock_) {
+            readAhead_ = std::min(std::max(2 * readAhead_, static_cast<size_t>(1)),
+                                  std::max(maxReadAhead / blockSize_, static_cast<size_t>(1)));
+        } else {
+            readAhead_ = 0;
+        }
+        highBlock = std::min(highBlock + readAhead_, nBlocks - 1);
+        nextBlock_ = highBlock + 1;
+        populateBlocks(lowBlock, highBlock);
+    }
+
     RemoteIo::Impl::~Impl() {
         delete[] blocksMap_;
     }
@@ -1721,6 +2237,7 @@ namespace Exiv2 {
                 size_t nBlocks = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
                 p_->blocksMap_  = new BlockMap[nBlocks];
                 p_->isMalloced_ = true;
+                p_->openCache();
             }
         }
         return 0; // means OK
@@ -1732,6 +2249,9 @@ namespace Exiv2 {
             p_->eof_ = false;
             p_->idx_ = 0;
         }
+        p_->readAhead_ = 0;
+        p_->nextBlock_ = 0;
+        p_->prefetch_.clear();
 #ifdef EXIV2_DEBUG_MESSAGES
         std::cerr << "RemoteIo::close totalRead_ = " << p_->totalRead_ << std::endl;
 #endif
@@ -1754,73 +2274,139 @@ namespace Exiv2 {
 
         /*
          * The idea is to compare the file content, find the different bytes and submit them to the remote machine.
-         * To simplify it, it:
          *      + goes from the left, find the first different position -> $left
          *      + goes from the right, find the first different position -> $right
-         * The different bytes are [$left-$right] part.
+         * If the size is unchanged, the part [$left-$right] is split into the ranges of blocks which differ,
+         * else the [$left-$right] part of the file is replaced.
          */
-        size_t left       = 0;
-        size_t right      = 0;
-        size_t blockIndex = 0;
-        size_t i          = 0;
-        size_t readCount  = 0;
-        size_t blockSize  = 0;
-        auto buf = new byte [p_->blockSize_];
-        size_t nBlocks    = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
+        const size_t srcSize = src.size();
+        const size_t nBlocks = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
+        std::vector<byte> buf(p_->blockSize_);
+
+        // compare count bytes of block iBlock, starting at offset, with the data in buf
+        // and return the position of the first (or last) different byte, count if they are equal
+        auto diff = [&](size_t iBlock, size_t offset, size_t count, bool last) -> size_t {
+            const BlockMap& block = p_->blocksMap_[iBlock];
+            if (block.isNone()) return last ? count - 1 : 0;
+            for (size_t i = 0; i < count; i++) {
+                size_t k = last ? count - i - 1 : i;
+                byte b = block.isKnown() ? 0 : block.getData()[offset + k]; // known blocks are fake data
+                if (buf[k] != b) return k;
+            }
+            return count;
+        };
 
         // find $left
+        size_t left = 0;
         src.seek(0, BasicIo::beg);
-        bool findDiff = false;
-        while (blockIndex < nBlocks && !src.eof() && !findDiff) {
-            blockSize = p_->blocksMap_[blockIndex].getSize();
-            bool isFakeData = p_->blocksMap_[blockIndex].isKnown(); // fake data
-            readCount = static_cast<size_t>(src.read(buf, static_cast<long>(blockSize)));
-            byte* blockData = p_->blocksMap_[blockIndex].getData();
-            for (i = 0; (i < readCount) && (i < blockSize) && !findDiff; i++) {
-                if ((!isFakeData && buf[i] != blockData[i]) || (isFakeData && buf[i] != 0)) {
-                    findDiff = true;
-                } else {
-                    left++;
-                }
-            }
-            blockIndex++;
+        for (size_t iBlock = 0; iBlock < nBlocks; iBlock++) {
+            size_t blockSize = p_->blocksMap_[iBlock].getSize();
+            size_t readCount = src.read(buf.data(), static_cast<long>(blockSize));
+            size_t i = diff(iBlock, 0, readCount, false);
+            left += i;
+            if (i < blockSize) break;
         }
 
         // find $right
-        findDiff    = false;
-        blockIndex  = nBlocks;
-        while (blockIndex > 0 && right < src.size() && !findDiff) {
-            blockIndex--;
-            blockSize = p_->blocksMap_[blockIndex].getSize();
-            if(src.seek(-1 * (blockSize + right), BasicIo::end)) {
-                findDiff = true;
-            } else {
-                bool isFakeData = p_->blocksMap_[blockIndex].isKnown(); // fake data
-                readCount = src.read(buf, static_cast<long>(blockSize));
-                byte* blockData = p_->blocksMap_[blockIndex].getData();
-                for (i = 0; (i < readCount) && (i < blockSize) && !findDiff; i++) {
-                    if ((!isFakeData && buf[readCount - i - 1] != blockData[blockSize - i - 1]) || (isFakeData && buf[readCount - i - 1] != 0)) {
-                        findDiff = true;
-                    } else {
-                        right++;
-                    }
+        size_t right = 0;
+        const size_t common = std::min(p_->size_, srcSize) - std::min(left, std::min(p_->size_, srcSize));
+        for (size_t iBlock = nBlocks; iBlock > 0 && right < common; ) {
+            iBlock--;
+            size_t blockSize = p_->blocksMap_[iBlock].getSize();
+            size_t count = std::min(blockSize, common - right);
+            if (src.seek(-static_cast<long>(count + right), BasicIo::end) != 0) break;
+            if (src.read(buf.data(), static_cast<long>(count)) != static_cast<long>(count)) break;
+            size_t i = diff(iBlock, blockSize - count, count, true);
+            if (i < count) {
+                right += count - i - 1;
+                break;
+            }
+            right += count;
+        }
+
+        // the ranges [from, to) of the remote file to replace
+        std::vector<std::pair<size_t, size_t> > ranges;
+        if (srcSize != p_->size_) {
+            ranges.emplace_back(left, p_->size_ - right);
+        } else if (left + right < srcSize) {
+            const size_t changedEnd = srcSize - right;
+            for (size_t iBlock = left / p_->blockSize_; iBlock * p_->blockSize_ < changedEnd; iBlock++) {
+                const size_t start = iBlock * p_->blockSize_;
+                const size_t count = std::min(p_->blocksMap_[iBlock].getSize(), changedEnd - start);
+                src.seek(static_cast<long>(start), BasicIo::beg);
+                if (src.read(buf.data(), static_cast<long>(count)) != static_cast<long>(count)) {
+                    throw Error(kerInputDataReadFailed);
+                }
+                size_t first = diff(iBlock, 0, count, false);
+                if (first == count) continue;
+                size_t from = start + first;
+                size_t to = start + diff(iBlock, 0, count, true) + 1;
+                // a request costs more than sending a gap shorter than a block
+                if (!ranges.empty() && from - ranges.back().second < p_->blockSize_) {
+                    ranges.back().second = to;
+                } else {
+                    ranges.emplace_back(from, to);
                 }
             }
         }
 
-        delete []buf;
-
         // submit to the remote machine.
-        long dataSize = static_cast<long>(src.size() - left - right);
-        if (dataSize > 0) {
-            auto data = static_cast<byte*>(std::malloc(dataSize));
-            src.seek(left, BasicIo::beg);
-            src.read(data, dataSize);
-            p_->writeRemote(data, static_cast<size_t>(dataSize), static_cast<long>(left),
-                            static_cast<long>(p_->size_ - right));
-            if (data) std::free(data);
+        DataBuf data;
+        auto submit = [&](size_t from, size_t to, size_t count) {
+            data.alloc(static_cast<long>(count));
+            src.seek(static_cast<long>(from), BasicIo::beg);
+            if (src.read(data.data(), static_cast<long>(count)) != static_cast<long>(count)) {
+                throw Error(kerInputDataReadFailed);
+            }
+            p_->writeRemote(data.c_data(), count, static_cast<long>(from), static_cast<long>(to));
+        };
+        try {
+            for (auto&& range : ranges) {
+                size_t count = (srcSize == p_->size_) ? range.second - range.first
+                                                      : srcSize - left - right;
+                submit(range.first, range.second, count);
+            }
+        } catch (const Error& e) {
+            // the server may not support writing a part of the file, upload all of it,
+            // unless the request failed and the remote file may have changed
+            if (e.code() != kerFileOpenFailed) throw;
+            if (ranges.size() == 1 && ranges.front().first == 0 && ranges.front().second == p_->size_) throw;
+            // the unchanged parts of src may be fake data, copy them from the remote file
+            std::vector<std::pair<size_t, size_t> > unchanged; // [from, to) of the remote file
+            if (srcSize != p_->size_) {
+                unchanged.emplace_back(0, left);
+                unchanged.emplace_back(p_->size_ - right, p_->size_);
+            } else {
+                size_t from = 0;
+                for (auto&& range : ranges) {
+                    unchanged.emplace_back(from, range.first);
+                    from = range.second;
+                }
+                unchanged.emplace_back(from, p_->size_);
+            }
+            for (size_t iBlock = 0; iBlock < nBlocks; iBlock++) {
+                p_->blocksMap_[iBlock].markNone();
+            }
+            p_->populateBlocks(0, nBlocks - 1);
+            data.alloc(static_cast<long>(srcSize));
+            src.seek(0, BasicIo::beg);
+            if (src.read(data.data(), static_cast<long>(srcSize)) != static_cast<long>(srcSize)) {
+                throw Error(kerInputDataReadFailed);
+            }
+            for (auto&& range : unchanged) {
+                // the tail is moved by the change of the size
+                size_t to = (range.first == 0 || srcSize == p_->size_) ? range.first : range.first + srcSize - p_->size_;
+                for (size_t pos = range.first; pos < range.second; ) {
+                    const BlockMap& block = p_->blocksMap_[pos / p_->blockSize_];
+                    size_t offset = pos % p_->blockSize_;
+                    size_t count = std::min(block.getSize() - offset, range.second - pos);
+                    std::memcpy(data.data(to + pos - range.first), block.getData() + offset, count);
+                    pos += count;
+                }
+            }
+            p_->writeRemote(data.c_data(), srcSize, 0, static_cast<long>(p_->size_));
         }
-        return static_cast<long>(src.size());
+        return static_cast<long>(srcSize);
     }
 
     int RemoteIo::putb(byte /*unused data*/)
@@ -1850,7 +2436,7 @@ namespace Exiv2 {
         size_t highBlock = (p_->idx_ + allow)/p_->blockSize_;
 
         // connect to the remote machine & populate the blocks just in time.
-        p_->populateBlocks(lowBlock, highBlock);
+        p_->readBlocks(lowBlock, highBlock);
         auto fakeData = static_cast<byte*>(std::calloc(p_->blockSize_, sizeof(byte)));
         if (!fakeData) {
             throw Error(kerErrorMessage, "Unable to allocate data");
@@ -1888,7 +2474,7 @@ namespace Exiv2 {
 
         size_t expectedBlock = p_->idx_/p_->blockSize_;
         // connect to the remote machine & populate the blocks just in time.
-        p_->populateBlocks(expectedBlock, expectedBlock);
+        p_->readBlocks(expectedBlock, expectedBlock);
 
         byte* data = p_->blocksMap_[expectedBlock].getData();
         return data[p_->idx_++ - expectedBlock*p_->blockSize_];
@@ -1944,27 +2530,37 @@ namespace Exiv2 {
 
     byte* RemoteIo::mmap(bool /*isWriteable*/)
     {
-        size_t nRealData = 0 ;
-        if ( !bigBlock_ ) {
-            size_t blockSize = p_->blockSize_;
-            size_t blocks = (p_->size_ + blockSize -1)/blockSize ;
-            bigBlock_   = new byte[blocks*blockSize] ;
-            for ( size_t block = 0 ; block < blocks ; block ++ ) {
-                void* p = p_->blocksMap_[block].getData();
-                if  ( p ) {
-                    size_t nRead = block==(blocks-1)?p_->size_-nRealData:blockSize;
-                    memcpy(bigBlock_+(block*blockSize),p,nRead);
-                    nRealData   += nRead ;
-                }
-            }
-#ifdef EXIV2_DEBUG_MESSAGES
-            std::cerr << "RemoteIo::mmap nRealData = " << nRealData << std::endl;
-#endif
+        mmapSparse();
+        const size_t nBlocks = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
+        if (nBlocks > 0) {
+            p_->populateBlocks(0, nBlocks - 1);
+            p_->mapBlocks(bigBlock_, 0, nBlocks - 1);
         }
+        return bigBlock_;
+    }
 
+    const byte* RemoteIo::mmapSparse()
+    {
+        const size_t nBlocks = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
+        if (!bigBlock_) {
+            // the pages of the blocks which are never mapped are not touched
+            bigBlock_ = new byte[nBlocks * p_->blockSize_];
+            p_->mapped_.assign(nBlocks, false);
+        }
+        p_->populateRanges({});
+        if (nBlocks > 0) p_->mapBlocks(bigBlock_, 0, nBlocks - 1);
         return bigBlock_;
     }
 
+    void RemoteIo::populateMap(long offset, long size)
+    {
+        if (!bigBlock_ || offset < 0 || size <= 0 || static_cast<size_t>(offset) >= p_->size_) return;
+        const size_t lowBlock = static_cast<size_t>(offset) / p_->blockSize_;
+        const size_t highBlock = (std::min(static_cast<size_t>(offset) + static_cast<size_t>(size), p_->size_) - 1) / p_->blockSize_;
+        p_->populateBlocks(lowBlock, highBlock);
+        p_->mapBlocks(bigBlock_, lowBlock, highBlock);
+    }
+
     int RemoteIo::munmap()
     {
         return 0;
@@ -2007,13 +2603,21 @@ namespace Exiv2 {
     }
 #endif
 
+    void RemoteIo::prefetch(long offset, long size)
+    {
+        if (!p_->isMalloced_ || offset < 0 || size <= 0 || static_cast<size_t>(offset) >= p_->size_) return;
+        const size_t last = std::min(static_cast<size_t>(offset) + static_cast<size_t>(size), p_->size_) - 1;
+        p_->prefetch_.emplace_back(offset / static_cast<long>(p_->blockSize_),
+                                   static_cast<long>(last / p_->blockSize_));
+    }
+
     void RemoteIo::populateFakeData()
     {
         assert(p_->isMalloced_);
         size_t nBlocks = (p_->size_ + p_->blockSize_ - 1) / p_->blockSize_;
         for (size_t i = 0; i < nBlocks; i++) {
             if (p_->blocksMap_[i].isNone())
-                p_->blocksMap_[i].markKnown(p_->blockSize_);
+                p_->blocksMap_[i].markKnown(std::min(p_->blockSize_, p_->size_ - i * p_->blockSize_));
         }
     }
 
@@ -2045,6 +2649,15 @@ namespace Exiv2 {
           @note Set lowBlock = -1 and highBlock = -1 to get the whole file content.
          */
         void getDataByRange(long lowBlock, long highBlock, std::string& response) override;
+        /*!
+          @brief Get the data of several ranges of blocks. The range requests are
+                pipelined on one persistent connection.
+          @param ranges The start and end block index of each range.
+          @param responses The data from the server, one for each range.
+          @throw Error if the server returns the error code.
+         */
+        void getDataByRanges(const std::vector<std::pair<long, long> >& ranges,
+                             std::vector<std::string>& responses) override;
         /*!
           @brief Submit the data to the remote machine. The data replace a part of the remote file.
                 The replaced part of remote file is indicated by from and to parameters.
@@ -2084,44 +2697,75 @@ namespace Exiv2 {
 
     long HttpIo::HttpImpl::getFileLength()
     {
-        Exiv2::Dictionary response;
-        Exiv2::Dictionary request;
+        std::vector<Exiv2::Dictionary> responses;
+        std::vector<Exiv2::Dictionary> requests(1);
+        Exiv2::Dictionary& request = requests.front();
         std::string errors;
         request["server"] = hostInfo_.Host;
         request["page"  ] = hostInfo_.Path;
         if (!hostInfo_.Port.empty())
             request["port"] = hostInfo_.Port;
         request["verb"]   = "HEAD";
-        int serverCode = http(request, response, errors);
+        int serverCode = http(requests, responses, errors);
         if (serverCode < 0 || serverCode >= 400 || !errors.empty()) {
             throw Error(kerFileOpenFailed, "http",Exiv2::Internal::stringFormat("%d",serverCode), hostInfo_.Path);
         }
 
+        const Exiv2::Dictionary& response = responses.front();
+        // the validator identifies the version of the file in the block cache
+        validator_.clear();
+        for (auto&& header : response) {
+            std::string key(header.first);
+            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+            if (key == "etag") {
+                validator_ = header.second;
+                break;
+            }
+            if (key == "last-modified") {
+                validator_ = header.second;
+            }
+        }
         auto lengthIter = response.find("Content-Length");
         return (lengthIter == response.end()) ? -1 : atol((lengthIter->second).c_str());
     }
 
     void HttpIo::HttpImpl::getDataByRange(long lowBlock, long highBlock, std::string& response)
     {
-        Exiv2::Dictionary responseDic;
-        Exiv2::Dictionary request;
-        request["server"] = hostInfo_.Host;
-        request["page"  ] = hostInfo_.Path;
-        if (!hostInfo_.Port.empty())
-            request["port"] = hostInfo_.Port;
-        request["verb"]   = "GET";
-        std::string errors;
-        if (lowBlock > -1 && highBlock > -1) {
-            std::stringstream ss;
-            ss << "Range: bytes=" << lowBlock * blockSize_  << "-" << ((highBlock + 1) * blockSize_ - 1) << "\r\n";
-            request["header"] = ss.str();
+        std::vector<std::string> responses;
+        getDataByRanges(std::vector<std::pair<long, long> >(1, std::make_pair(lowBlock, highBlock)), responses);
+        response.swap(responses.front());
+    }
+
+    void HttpIo::HttpImpl::getDataByRanges(const std::vector<std::pair<long, long> >& ranges,
+                                           std::vector<std::string>& responses)
+    {
+        std::vector<Exiv2::Dictionary> responseDics;
+        std::vector<Exiv2::Dictionary> requests(ranges.size());
+        for (size_t i = 0; i < ranges.size(); i++) {
+            Exiv2::Dictionary& request = requests[i];
+            request["server"] = hostInfo_.Host;
+            request["page"  ] = hostInfo_.Path;
+            if (!hostInfo_.Port.empty())
+                request["port"] = hostInfo_.Port;
+            request["verb"]   = "GET";
+            const long lowBlock = ranges[i].first;
+            const long highBlock = ranges[i].second;
+            if (lowBlock > -1 && highBlock > -1) {
+                std::stringstream ss;
+                ss << "Range: bytes=" << lowBlock * blockSize_  << "-" << ((highBlock + 1) * blockSize_ - 1) << "\r\n";
+                request["header"] = ss.str();
+            }
         }
 
-        int serverCode = http(request, responseDic, errors);
+        std::string errors;
+        int serverCode = http(requests, responseDics, errors);
         if (serverCode < 0 || serverCode >= 400 || !errors.empty()) {
             throw Error(kerFileOpenFailed, "http",Exiv2::Internal::stringFormat("%d",serverCode), hostInfo_.Path);
         }
-        response = responseDic["body"];
+        responses.resize(ranges.size());
+        for (size_t i = 0; i < ranges.size(); i++) {
+            responses[i].swap(responseDics[i]["body"]);
+        }
     }
 
     void HttpIo::HttpImpl::writeRemote(const byte* data, size_t size, long from, long to)
@@ -2137,14 +2781,17 @@ namespace Exiv2 {
             scriptPath = "/" + scriptPath;
         }
 
-        Exiv2::Dictionary response;
-        Exiv2::Dictionary request;
+        std::vector<Exiv2::Dictionary> responses;
+        std::vector<Exiv2::Dictionary> requests(1);
+        Exiv2::Dictionary& request = requests.front();
         std::string errors;
 
         Uri scriptUri = Exiv2::Uri::Parse(scriptPath);
+        // a script path without host is on the server of the file
         request["server"] = scriptUri.Host.empty() ? hostInfo_.Host : scriptUri.Host;
-        if (!scriptUri.Port.empty())
-            request["port"] = scriptUri.Port;
+        const std::string& port = scriptUri.Host.empty() ? hostInfo_.Port : scriptUri.Port;
+        if (!port.empty())
+            request["port"] = port;
         request["page"] = scriptUri.Path;
         request["verb"] = "POST";
 
@@ -2161,17 +2808,20 @@ namespace Exiv2 {
            << "from="   << from           << "&"
            << "to="     << to             << "&"
            << "data="   << urlencodeData;
-        std::string postData = ss.str();
+        request["body"] = ss.str();
 
         // create the header
         ss.str("");
-        ss << "Content-Length: " << postData.length()  << "\n"
-           << "Content-Type: application/x-www-form-urlencoded\n"
-           << "\n" << postData << "\r\n";
+        ss << "Content-Length: " << request["body"].length() << "\r\n"
+           << "Content-Type: application/x-www-form-urlencoded\r\n";
         request["header"] = ss.str();
 
-        int serverCode = http(request, response, errors);
-        if (serverCode < 0 || serverCode >= 400 || !errors.empty()) {
+        int serverCode = http(requests, responses, errors);
+        // without a response the data may or may not have been written
+        if (serverCode < 0) {
+            throw Error(kerTransferFailed, hostInfo_.Path, "no response from the server");
+        }
+        if (serverCode >= 400 || !errors.empty()) {
             throw Error(kerFileOpenFailed, "http",Exiv2::Internal::stringFormat("%d",serverCode), hostInfo_.Path);
         }
     }
@@ -0,0 +1,234 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+// included header files
+#include "config.h"
+#include "blockcache_int.hpp"
+
+// + standard includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef EXV_HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef EXV_HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#if defined(EXV_HAVE_MMAP) && defined(EXV_HAVE_UNISTD_H) && defined(F_SETLKW)
+# define EXV_BLOCKCACHE 1
+#endif
+
+// *****************************************************************************
+namespace {
+    //! Layout of the header at the start of the cache file
+    struct CacheHeader {
+        char     magic[8];                      //!< Identifies the file and its version
+        uint32_t blockSize;                     //!< Size of a block
+        uint32_t nSets;                         //!< Number of sets
+    };
+
+    //! Layout of the descriptor of a slot
+    struct CacheSlot {
+        uint64_t file;                          //!< Key of the file of the block
+        uint64_t block;                         //!< Index of the block
+        uint64_t used;                          //!< Time of last use, relative to the set
+        uint32_t size;                          //!< Size of the block, 0 if the slot is empty
+        uint32_t reserved;                      //!< Unused
+    };
+
+    const char     cacheMagic[8] = { 'e', 'x', 'v', '2', 'b', 'l', 'k', '1' };
+    const size_t   headerSize = 64;             //!< Space for the header, the slots follow
+    const uint64_t fnvOffset = 14695981039346656037ULL;
+    const uint64_t fnvPrime = 1099511628211ULL;
+
+    //! fcntl(2) locks are held per process, this serializes the threads of the process
+    std::mutex cacheMutex;
+
+    //! FNV-1a hash of \em size bytes at \em data, continuing from \em hash
+    uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+    {
+        auto p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ p[i]) * fnvPrime;
+        }
+        return hash;
+    }
+}
+
+// *****************************************************************************
+// class member definitions
+namespace Exiv2 {
+    namespace Internal {
+
+    BlockCache::BlockCache(const std::string& dir, size_t blockSize, size_t maxSize)
+        : fd_(-1), base_(nullptr), mapSize_(0), blockSize_(blockSize), nSets_(0)
+    {
+#ifdef EXV_BLOCKCACHE
+        if (blockSize == 0 || dir.empty()) return;
+        const std::string path = dir + EXV_SEPARATOR_STR + "exiv2-" + std::to_string(blockSize) + ".cache";
+        const size_t slotsPerSet = ways * (sizeof(CacheSlot) + blockSize);
+        CacheHeader header;
+        struct stat buf;
+        // the cache file is complete when it appears under its name, so it
+        // can be checked without a lock
+        fd_ = ::open(path.c_str(), O_RDWR);
+        bool valid = fd_ >= 0
+            && ::fstat(fd_, &buf) == 0
+            && ::pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+            && std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0
+            && header.blockSize == blockSize
+            && header.nSets > 0
+            && static_cast<size_t>(buf.st_size) == headerSize + header.nSets * slotsPerSet;
+        if (!valid) {
+            // Other processes may have the file mapped, truncating it would
+            // crash them. Build a new file under a temporary name and rename
+            // it into place, they keep using the old one.
+            if (fd_ >= 0) ::close(fd_);
+            std::string temp = path + ".XXXXXX";
+            fd_ = ::mkstemp(&temp[0]);
+            if (fd_ < 0) return;
+            std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+            header.blockSize = static_cast<uint32_t>(blockSize);
+            header.nSets = static_cast<uint32_t>(std::min(std::max(maxSize / (ways * blockSize), static_cast<size_t>(1)),
+                                                          static_cast<size_t>(std::numeric_limits<uint32_t>::max() / ways)));
+            valid = ::ftruncate(fd_, headerSize + header.nSets * slotsPerSet) == 0
+                && ::pwrite(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+                && ::rename(temp.c_str(), path.c_str()) == 0;
+            if (!valid) {
+                ::unlink(temp.c_str());
+                ::close(fd_);
+                fd_ = -1;
+                return;
+            }
+        }
+
+        nSets_ = header.nSets;
+        mapSize_ = headerSize + nSets_ * slotsPerSet;
+        void* map = ::mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map != MAP_FAILED) base_ = static_cast<byte*>(map);
+#else
+        (void)dir;
+        (void)maxSize;
+#endif
+    }
+
+    BlockCache::~BlockCache()
+    {
+#ifdef EXV_BLOCKCACHE
+        if (base_) ::munmap(base_, mapSize_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    uint64_t BlockCache::fileKey(const std::string& url, const std::string& validator, size_t size)
+    {
+        const uint64_t size64 = size;
+        uint64_t hash = fnv1a(fnvOffset, url.c_str(), url.size() + 1);
+        hash = fnv1a(hash, validator.c_str(), validator.size() + 1);
+        return fnv1a(hash, &size64, sizeof(size64));
+    }
+
+    uint32_t BlockCache::set(uint64_t file, uint64_t block) const
+    {
+        const uint64_t hash = fnv1a(fnv1a(fnvOffset, &file, sizeof(file)), &block, sizeof(block));
+        return static_cast<uint32_t>(hash % nSets_) * ways;
+    }
+
+    bool BlockCache::lock(uint32_t first, bool on) const
+    {
+#ifdef EXV_BLOCKCACHE
+        struct flock fl;
+        std::memset(&fl, 0, sizeof(fl));
+        fl.l_type = on ? F_WRLCK : F_UNLCK;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = headerSize + first * sizeof(CacheSlot);
+        fl.l_len = ways * sizeof(CacheSlot);
+        return ::fcntl(fd_, on ? F_SETLKW : F_SETLK, &fl) == 0;
+#else
+        (void)first;
+        (void)on;
+        return false;
+#endif
+    }
+
+    size_t BlockCache::get(uint64_t file, uint64_t block, byte* buf)
+    {
+        if (!good()) return 0;
+        std::lock_guard<std::mutex> guard(cacheMutex);
+        const uint32_t first = set(file, block);
+        if (!lock(first, true)) return 0;
+
+        auto slots = reinterpret_cast<CacheSlot*>(base_ + headerSize) + first;
+        const byte* data = base_ + headerSize + nSets_ * ways * sizeof(CacheSlot) + first * blockSize_;
+        size_t size = 0;
+        uint64_t used = 0;
+        for (uint32_t i = 0; i < ways; i++) used = std::max(used, slots[i].used);
+        for (uint32_t i = 0; i < ways; i++) {
+            if (   slots[i].size == 0 || slots[i].size > blockSize_
+                || slots[i].file != file || slots[i].block != block) continue;
+            size = slots[i].size;
+            std::memcpy(buf, data + i * blockSize_, size);
+            slots[i].used = used + 1;
+            break;
+        }
+        lock(first, false);
+        return size;
+    }
+
+    void BlockCache::put(uint64_t file, uint64_t block, const byte* data, size_t size)
+    {
+        if (!good() || size == 0 || size > blockSize_) return;
+        std::lock_guard<std::mutex> guard(cacheMutex);
+        const uint32_t first = set(file, block);
+        if (!lock(first, true)) return;
+
+        auto slots = reinterpret_cast<CacheSlot*>(base_ + headerSize) + first;
+        byte* blocks = base_ + headerSize + nSets_ * ways * sizeof(CacheSlot) + first * blockSize_;
+        // use the slot of the block, else an empty one, else the least recently used
+        uint32_t victim = 0;
+        uint64_t used = 0;
+        for (uint32_t i = 0; i < ways; i++) used = std::max(used, slots[i].used);
+        for (uint32_t i = 0; i < ways; i++) {
+            if (slots[i].size != 0 && slots[i].file == file && slots[i].block == block) {
+                victim = i;
+                break;
+            }
+            if (slots[victim].size != 0 && (slots[i].size == 0 || slots[i].used < slots[victim].used)) {
+                victim = i;
+            }
+        }
+        CacheSlot& slot = slots[victim];
+        slot.size = 0;
+        std::memcpy(blocks + victim * blockSize_, data, size);
+        slot.file = file;
+        slot.block = block;
+        slot.used = used + 1;
+        slot.size = static_cast<uint32_t>(size);
+        lock(first, false);
+    }
+
+}}                                      // namespace Internal, Exiv2
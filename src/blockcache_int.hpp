@@ -0,0 +1,127 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+/*!
+  @file    blockcache_int.hpp
+  @brief   Persistent cache of the blocks of remote files
+ */
+#ifndef BLOCKCACHE_INT_HPP_
+#define BLOCKCACHE_INT_HPP_
+
+// *****************************************************************************
+// included header files
+#include "types.hpp"
+
+// + standard includes
+#include <string>
+
+// *****************************************************************************
+// namespace extensions
+namespace Exiv2 {
+    namespace Internal {
+
+// *****************************************************************************
+// class definitions
+
+    /*!
+      @brief Cache of the blocks of remote files in a memory mapped file,
+             shared by all processes which use the same cache directory.
+
+      The cache file holds a fixed number of slots of one block each. A
+      block is identified by the key of its file, see fileKey(), and its
+      index. The slots are organized in sets of \em ways slots, a block can
+      only be stored in the set selected by a hash of its identity. When a
+      set is full, the least recently used slot of the set is replaced.
+
+      Each set is protected by an advisory lock on its part of the file, so
+      concurrent readers and writers in other processes are safe. A block
+      is removed from its slot before the slot is overwritten and only
+      added again when the data is complete. The cache file is never
+      truncated while other processes may have it mapped, a new file is
+      built under a temporary name and renamed into place.
+
+      The cache is available on platforms with mmap(2) and fcntl(2) locks.
+      Elsewhere, good() is always false.
+     */
+    class BlockCache {
+    public:
+        //! @name Creators
+        //@{
+        /*!
+          @brief Open the cache file for blocks of \em blockSize bytes in
+                 directory \em dir, create it if it does not exist or
+                 is not valid.
+
+          @param dir       Directory of the cache file.
+          @param blockSize Size of a block in bytes.
+          @param maxSize   Upper limit of the size of the cached data in
+                           bytes, used when the cache file is created.
+         */
+        BlockCache(const std::string& dir, size_t blockSize, size_t maxSize);
+        //! Destructor, unmaps and closes the cache file
+        ~BlockCache();
+        //@}
+
+        //! @name Manipulators
+        //@{
+        /*!
+          @brief Copy the block \em block of the file \em file to \em buf,
+                 which must have room for one block.
+          @return The size of the block, 0 if it is not in the cache.
+         */
+        size_t get(uint64_t file, uint64_t block, byte* buf);
+        //! Store \em size bytes of data of the block \em block of the file \em file
+        void put(uint64_t file, uint64_t block, const byte* data, size_t size);
+        //@}
+
+        //! @name Accessors
+        //@{
+        //! Return true if the cache file is open and mapped
+        bool good() const { return base_ != nullptr; }
+        //@}
+
+        /*!
+          @brief Return the key of a remote file, computed from its URL,
+                 validator (ETag or Last-Modified) and size.
+         */
+        static uint64_t fileKey(const std::string& url, const std::string& validator, size_t size);
+
+        // NOT IMPLEMENTED
+        BlockCache(const BlockCache& rhs) = delete;             //!< Copy constructor
+        BlockCache& operator=(const BlockCache& rhs) = delete;  //!< Assignment
+
+    private:
+        //! Return the index of the first slot of the set of a block
+        uint32_t set(uint64_t file, uint64_t block) const;
+        //! Lock the slots of the set starting at slot \em first, or unlock them
+        bool lock(uint32_t first, bool on) const;
+
+        // DATA
+        static const uint32_t ways = 8;         //!< Number of slots per set
+        int      fd_;                           //!< Cache file
+        byte*    base_;                         //!< Mapping of the cache file
+        size_t   mapSize_;                      //!< Size of the mapping
+        size_t   blockSize_;                    //!< Size of a block
+        uint32_t nSets_;                        //!< Number of sets
+
+    }; // class BlockCache
+
+}}                                      // namespace Internal, Exiv2
+
+#endif                                  // #ifndef BLOCKCACHE_INT_HPP_
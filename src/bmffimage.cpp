@@ -39,6 +39,7 @@
 #include "unused.h"
 
 // + standard includes
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
@@ -123,6 +124,13 @@ namespace Exiv2
         return box == TAG_meta || box == TAG_iinf || box == TAG_iloc;
     }
 
+    bool BmffImage::dataBox(uint32_t box)
+    {
+        // boxes which are parsed from memory, the others are read from io_ or skipped
+        return box == TAG_ftyp || box == TAG_iinf || box == TAG_infe || box == TAG_iloc || box == TAG_ispe ||
+               box == TAG_colr;
+    }
+
     std::string BmffImage::mimeType() const
     {
         switch (fileType_) {
@@ -228,10 +236,16 @@ namespace Exiv2
         long restore = io_->tell();
         enforce(box_length >= hdrsize, Exiv2::kerCorruptedMetadata);
         enforce(box_length - hdrsize <= static_cast<size_t>(pbox_end - restore), Exiv2::kerCorruptedMetadata);
-        DataBuf data(static_cast<long>(box_length - hdrsize));
-        const long box_end = restore + data.size();
-        io_->read(data.data(), data.size());
-        io_->seek(restore, BasicIo::beg);
+        const long box_end = restore + static_cast<long>(box_length - hdrsize);
+        // Only read the body of boxes which are parsed from memory. Of the
+        // others only the version/flags are needed, large boxes like mdat
+        // are skipped.
+        DataBuf data(dataBox(box_type) ? box_end - restore
+                     : fullBox(box_type) ? std::min(4L, box_end - restore) : 0);
+        if (data.size() > 0) {
+            enforce(io_->read(data.data(), data.size()) == data.size(), Exiv2::kerCorruptedMetadata);
+            io_->seek(restore, BasicIo::beg);
+        }
 
         long skip = 0;  // read position in data.pData_
         uint8_t version = 0;
@@ -530,6 +544,7 @@ namespace Exiv2
                 throw Error(kerInputDataReadFailed);
             if ( io_->error() )
                 throw Error(kerFailedToReadImageData);
+            // Decoded right away, so that a corrupt packet fails the read
             try {
                 Exiv2::XmpParser::decode(xmpData(), std::string(xmp.c_str()));
             } catch (...) {
@@ -2731,7 +2731,7 @@ namespace Exiv2 {
             }
         } catch (std::exception&) {};
 
-        return EXV_PRINT_TAG(canonCsLensType)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(canonCsLensType)(os, value, metadata);
     }
 
     std::ostream& printCsLensTypeByMetadata(std::ostream& os, const Value& value, const ExifData* metadata)
@@ -2768,8 +2768,8 @@ namespace Exiv2 {
         auto exifAperMax = fnumber(canonEv(static_cast<int16_t>(pos->value().toLong(0))));
 
         // regex to extract short and tele focal length, max aperture at short and tele position
-        // and the teleconverter factor from the lens label
-        std::regex const lens_regex(
+        // and the teleconverter factor from the lens label, compiled only once
+        static const std::regex lens_regex(
             // anything at the start
             ".*?"
             // maybe min focal length and hyphen, surely max focal length e.g.: 24-70mm
@@ -2785,18 +2785,14 @@ namespace Exiv2 {
             );
 
         bool unmatched = true;
-        // we loop over all our lenses to print out all matching lenses
+        // we loop over all lenses with the lens type to print out all matching lenses
         // if we have multiple possibilities, they are concatenated by "*OR*"
-        for (auto const& lens : canonCsLensType) {
-            if (lens.val_ != lensType) {
-                continue;
-            }
-
+        for (auto const& lens : EXV_FIND_ALL(canonCsLensType, lensType)) {
             std::cmatch base_match;
-            if (!std::regex_search(lens.label_, base_match, lens_regex)) {
+            if (!std::regex_search(lens->label_, base_match, lens_regex)) {
                 // this should never happen, as it would indicate the lens is specified incorrectly
                 // in the CanonCsLensType array
-                throw Error(kerErrorMessage, std::string("Lens regex didn't match for: ") + std::string(lens.label_));
+                throw Error(kerErrorMessage, std::string("Lens regex didn't match for: ") + std::string(lens->label_));
             }
 
             auto tc = base_match[5].length() > 0 ? std::stof(base_match[5].str()) : 1.f;
@@ -2814,11 +2810,11 @@ namespace Exiv2 {
 
             if (unmatched) {
                 unmatched = false;
-                os << lens.label_;
+                os << lens->label_;
                 continue;
             }
 
-            os << " *OR* " << lens.label_;
+            os << " *OR* " << lens->label_;
         }
 
         // if the entire for loop left us with unmatched==false
@@ -2840,8 +2836,9 @@ namespace Exiv2 {
         // #1034
         const std::string undefined("undefined") ;
         const std::string section  ("canon");
-        if ( Internal::readExiv2Config(section,value.toString(),undefined) != undefined ) {
-            return os << Internal::readExiv2Config(section,value.toString(),undefined);
+        const std::string lens = Internal::readExiv2Config(section,value.toString(),undefined);
+        if ( lens != undefined ) {
+            return os << lens;
         }
 
         // try our best to determine the lens based on metadata
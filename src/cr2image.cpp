@@ -102,8 +102,11 @@ namespace Exiv2 {
             throw Error(kerNotAnImage, "CR2");
         }
         clearMetadata();
-        ByteOrder bo =
-            Cr2Parser::decode(exifData_, iptcData_, xmpData_, io_->mmap(), static_cast<uint32_t>(io_->size()));
+        // Only the parts of the file which are parsed are read from remote IO
+        Cr2Header cr2Header;
+        ByteOrder bo = TiffParserWorker::decode(exifData_, iptcData_, xmpData_, io_->mmapSparse(),
+                                                static_cast<uint32_t>(io_->size()), Tag::root,
+                                                TiffMapping::findDecoder, &cr2Header, io_.get());
         setByteOrder(bo);
     } // Cr2Image::readMetadata
 
@@ -34,6 +34,7 @@
 #include "futils.hpp"
 #include "version.hpp"
 #include "utils.hpp"
+#include "image_int.hpp"
 
 // + standard includes
 #include <algorithm>
@@ -105,6 +106,9 @@ namespace {
     // closing part of all valid XMP trailers
     const std::string xmpTrailerEnd = "?>";
 
+    // common start of all valid XMP headers and trailers
+    const std::string xmpPacketStart = "<?xpacket ";
+
     //! Write data into temp file, taking care of errors
     void writeTemp(BasicIo& tempIo, const byte* data, size_t size)
     {
@@ -148,12 +152,10 @@ namespace {
     size_t readLine(std::string& line, const byte* data, size_t startPos, size_t size)
     {
         line.clear();
-        size_t pos = startPos;
+        if (startPos >= size) return startPos;
         // step through line
-        while (pos < size && data[pos] != '\r' && data[pos] != '\n') {
-            line += data[pos];
-            pos++;
-        }
+        size_t pos = Internal::findEither(data, startPos, size, '\r', '\n');
+        line.assign(reinterpret_cast<const char*>(data + startPos), pos - startPos);
         // skip line ending, if present
         if (pos >= size) return pos;
         pos++;
@@ -162,6 +164,17 @@ namespace {
         return pos;
     }
 
+    //! Find the next line after \em startPos which starts with '%', return \em size if there is none
+    size_t nextCommentLine(const byte* data, size_t startPos, size_t size)
+    {
+        for (size_t pos = startPos + 1; pos < size; pos++) {
+            pos = Internal::findBytes(data, pos, size, "%");
+            if (pos == size) break;
+            if (data[pos - 1] == '\r' || data[pos - 1] == '\n') return pos;
+        }
+        return size;
+    }
+
     //! Read the previous line of a buffer, allow for changing line ending style
     size_t readPrevLine(std::string& line, const byte* data, size_t startPos, size_t size)
     {
@@ -193,7 +206,8 @@ namespace {
         // search for valid XMP header
         xmpSize = 0;
         for (xmpPos = startPos; xmpPos < size; xmpPos++) {
-            if (data[xmpPos] != '\x00' && data[xmpPos] != '<') continue;
+            xmpPos = Internal::findBytes(data, xmpPos, size, xmpPacketStart);
+            if (xmpPos == size) break;
             for (auto&& header : xmpHeaders) {
                 if (xmpPos + header.size() > size) continue;
                 if (memcmp(data + xmpPos, header.data(), header.size()) != 0) continue;
@@ -203,7 +217,8 @@ namespace {
 
                 // search for valid XMP trailer
                 for (size_t trailerPos = xmpPos + header.size(); trailerPos < size; trailerPos++) {
-                    if (data[xmpPos] != '\x00' && data[xmpPos] != '<') continue;
+                    trailerPos = Internal::findBytes(data, trailerPos, size, xmpPacketStart);
+                    if (trailerPos == size) break;
                     for (auto&& xmpTrailer : xmpTrailers) {
                         const std::string& trailer = xmpTrailer.trailer;
                         const bool readOnly = xmpTrailer.readOnly;
@@ -223,11 +238,10 @@ namespace {
                         }
 
                         // search for end of XMP trailer
-                        for (size_t trailerEndPos = trailerPos + trailer.size(); trailerEndPos + xmpTrailerEnd.size() <= size; trailerEndPos++) {
-                            if (memcmp(data + trailerEndPos, xmpTrailerEnd.data(), xmpTrailerEnd.size()) == 0) {
-                                xmpSize = (trailerEndPos + xmpTrailerEnd.size()) - xmpPos;
-                                return;
-                            }
+                        const size_t trailerEndPos = Internal::findBytes(data, trailerPos + trailer.size(), size, xmpTrailerEnd);
+                        if (trailerEndPos != size) {
+                            xmpSize = (trailerEndPos + xmpTrailerEnd.size()) - xmpPos;
+                            return;
                         }
                         #ifndef SUPPRESS_WARNINGS
                         EXV_WARNING << "Found XMP header but incomplete XMP trailer.\n";
@@ -385,6 +399,12 @@ namespace {
         std::string removableEmbeddingEndLine;
         unsigned int removableEmbeddingsWithUnmarkedTrailer = 0;
         for (size_t pos = posEps; pos < posEof;) {
+            // once the implicit positions are known, only comment lines matter
+            if (data[pos] != '%' && posEndComments != posEndEps && posPage != posEndEps &&
+                posBeginPageSetup != posEndEps && posEndPageSetup != posEndEps) {
+                pos = nextCommentLine(data, pos, posEndEps);
+                if (pos >= posEof) break;
+            }
             const size_t startPos = pos;
             std::string line;
             pos = readLine(line, data, startPos, posEndEps);
@@ -802,7 +822,7 @@ namespace {
             }
 
             // create temporary output file
-            BasicIo::UniquePtr tempIo(new MemIo);
+            BasicIo::UniquePtr tempIo = Internal::createTempIo(io);
             assert (tempIo.get() != 0);
             if (!tempIo->isopen()) {
                 #ifndef SUPPRESS_WARNINGS
@@ -602,6 +602,11 @@ namespace Exiv2 {
         exifMetadata_.push_back(exifdatum);
     }
 
+    void ExifData::splice(iterator pos, ExifData& exifData)
+    {
+        exifMetadata_.splice(pos, exifData.exifMetadata_);
+    }
+
     ExifData::const_iterator ExifData::findKey(const ExifKey& key) const
     {
         return std::find_if(exifMetadata_.begin(), exifMetadata_.end(),
@@ -33,11 +33,16 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <cstring>
 #include <cassert>
 #include <cctype>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <regex>
+#include <thread>
 
 #if defined(_MSC_VER)
 #include <Windows.h>
@@ -72,6 +77,15 @@ namespace {
     int parseCommonTargets(const std::string& optArg,
                            const std::string& action);
 
+    /*!
+      @brief Modify all files of \em params with \em task, on \em jobs threads
+             with a copy of the task each. The verbose messages of a file are
+             collected and written together once the file is done.
+      @return The return code of the first file, in the order of the
+              command line, which failed; 0 if all succeeded.
+     */
+    int runParallel(const Action::Modify& task, const Params& params, long jobs);
+
     /*!
       @brief Parse numbers separated by commas into container
       @param previewNumbers Container for the numbers
@@ -156,19 +170,29 @@ int main(int argc, char* const argv[])
         Action::Task::UniquePtr task = taskFactory.create(Action::TaskType(params.action_));
         assert(task.get());
 
-        // Process all files
-        int n = 1;
-        int s = static_cast<int>(params.files_.size());
-        int w = s > 9 ? s > 99 ? 3 : 2 : 1;
-        for (auto&& file : params.files_) {
-            if (params.verbose_) {
-                std::cout << _("File") << " " << std::setw(w) << std::right << n++ << "/" << s << ": " << file
-                          << std::endl;
+        // Process all files. Registering namespaces changes state shared by
+        // all images, files are then modified one after the other.
+        bool parallel = params.jobs_ > 1 && params.files_.size() > 1 && params.action_ == Action::modify;
+        for (auto&& cmd : params.modifyCmds_) {
+            if (cmd.cmdId_ == reg) parallel = false;
+        }
+        if (parallel) {
+            rc = runParallel(dynamic_cast<const Action::Modify&>(*task), params,
+                             std::min(params.jobs_, static_cast<long>(params.files_.size())));
+        } else {
+            int n = 1;
+            int s = static_cast<int>(params.files_.size());
+            int w = s > 9 ? s > 99 ? 3 : 2 : 1;
+            for (auto&& file : params.files_) {
+                if (params.verbose_) {
+                    std::cout << _("File") << " " << std::setw(w) << std::right << n++ << "/" << s << ": " << file
+                              << std::endl;
+                }
+                task->setBinary(params.binary_);
+                int ret = task->run(file);
+                if (rc == 0)
+                    rc = ret;
             }
-            task->setBinary(params.binary_);
-            int ret = task->run(file);
-            if (rc == 0)
-                rc = ret;
         }
 
         taskFactory.cleanup();
@@ -298,6 +322,8 @@ void Params::help(std::ostream& os) const
        << _("   -K key  Only output where 'key' exactly matches tag's key\n")
        << _("   -n enc  Character set to decode Exif Unicode user comments\n")
        << _("   -k      Preserve file timestamps when updating files (keep)\n")
+       << _("   -j n    Number of files to modify in parallel with the 'modify' action,\n"
+            "           0 for one per processor\n")
        << _("   -t      Set the file timestamp from Exif metadata when renaming (overrides -k)\n")
        << _("   -T      Only set the file timestamp from Exif metadata ('rename' action)\n")
        << _("   -f      Do not prompt before overwriting existing files (force)\n")
@@ -336,6 +362,8 @@ void Params::help(std::ostream& os) const
        << _("             v : Plain data value, untranslated (vanilla)\n")
        << _("             t : Interpreted (translated) human readable values\n")
        << _("             h : Hex dump of the data\n")
+       << _("           json : All Exif, IPTC and XMP tags as JSON\n")
+       << _("         ndjson : Same as json, one line per file\n")
        << _("   -d tgt1  Delete target(s) for the 'delete' action. Possible targets are:\n")
        << _("             a : All supported metadata (the default)\n")
        << _("             e : Exif tags\n")
@@ -407,7 +435,10 @@ int Params::option(int opt, const std::string& optArg, int optOpt)
     case 'f': force_ = true; fileExistsPolicy_ = overwritePolicy; break;
     case 'F': force_ = true; fileExistsPolicy_ = renamePolicy; break;
     case 'g': rc = evalGrep(optArg); break;
-    case 'K': rc = evalKey(optArg); printMode_ = pmList; break;
+    case 'K':
+        rc = evalKey(optArg);
+        if (printMode_ != pmJson && printMode_ != pmNdJson) printMode_ = pmList;
+        break;
     case 'n': charset_ = optArg; break;
     case 'r': rc = evalRename(opt, optArg); break;
     case 't': rc = evalRename(opt, optArg); break;
@@ -427,6 +458,7 @@ int Params::option(int opt, const std::string& optArg, int optOpt)
     case 'M': rc = evalModify(opt, optArg); break;
     case 'l': directory_ = optArg; break;
     case 'S': suffix_ = optArg; break;
+    case 'j': rc = evalJobs(optArg); break;
     case ':':
         std::cerr << progname() << ": " << _("Option") << " -" << static_cast<char>(optOpt)
                    << " " << _("requires an argument\n");
@@ -673,6 +705,10 @@ int Params::evalPrintFlags(const std::string& optArg)
     switch (action_) {
     case Action::none:
         action_ = Action::print;
+        if (optArg == "json" || optArg == "ndjson") {
+            printMode_ = optArg == "json" ? pmJson : pmNdJson;
+            break;
+        }
         printMode_ = pmList;
         for (auto&& i : optArg) {
             switch (i) {
@@ -847,6 +883,16 @@ int Params::evalModify(int opt, const std::string& optArg)
     return rc;
 } // Params::evalModify
 
+int Params::evalJobs(const std::string& optArg)
+{
+    if (!Util::strtol(optArg.c_str(), jobs_) || jobs_ < 0) {
+        std::cerr << progname() << ": " << _("Error parsing -j option argument") << " `" << optArg << "'\n";
+        return 1;
+    }
+    if (jobs_ == 0) jobs_ = std::max(static_cast<long>(std::thread::hardware_concurrency()), 1L);
+    return 0;
+} // Params::evalJobs
+
 int Params::nonoption(const std::string& argv)
 {
     int rc = 0;
@@ -1048,6 +1094,7 @@ int Params::getopt(int argc, char* const Argv[])
     longs["--grep"     ] = "-g";
     longs["--help"     ] = "-h";
     longs["--insert"   ] = "-i";
+    longs["--jobs"     ] = "-j";
     longs["--keep"     ] = "-k";
     longs["--key"      ] = "-K";
     longs["--location" ] = "-l";
@@ -1269,6 +1316,48 @@ namespace {
         return rc ? rc : target;
     }
 
+    int runParallel(const Action::Modify& task, const Params& params, long jobs)
+    {
+        const size_t s = params.files_.size();
+        const int w = s > 9 ? s > 99 ? 3 : 2 : 1;
+        std::vector<int> results(s, 0);
+        std::atomic<size_t> next(0);
+        std::mutex coutMutex;
+        auto worker = [&]() {
+            Action::Modify::UniquePtr t = task.clone();
+            t->setBinary(params.binary_);
+            for (size_t i = next++; i < s; i = next++) {
+                const std::string& file = params.files_[i];
+                std::ostringstream out;
+                if (params.verbose_) {
+                    out << _("File") << " " << std::setw(w) << std::right << i + 1 << "/" << s << ": " << file
+                        << std::endl;
+                }
+                t->setOutput(out);
+                try {
+                    results[i] = t->run(file);
+                } catch (const std::exception& exc) {
+                    std::cerr << "Uncaught exception: " << exc.what() << std::endl;
+                    results[i] = 1;
+                }
+                std::lock_guard<std::mutex> guard(coutMutex);
+                std::cout << out.str() << std::flush;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (long i = 1; i < jobs; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+        for (auto&& ret : results) {
+            if (ret != 0) return ret;
+        }
+        return 0;
+    } // runParallel
+
     int parsePreviewNumbers(Params::PreviewNumbers& previewNumbers,
                             const std::string& optArg,
                             int j)
@@ -173,7 +173,9 @@ public:
         pmStructure,
         pmXMP,
         pmIccProfile,
-        pmRecursive
+        pmRecursive,
+        pmJson,
+        pmNdJson
     };
 
     //! Individual items to print, bitmap
@@ -253,6 +255,7 @@ public:
     std::vector<std::regex> greps_;     //!< List of keys to 'grep' from the metadata
     Keys keys_;                         //!< List of keys to match from the metadata
     std::string charset_;               //!< Charset to use for UNICODE Exif user comment
+    long jobs_;                         //!< Number of files to modify in parallel
 
     Exiv2::DataBuf  stdinBuf;           //!< DataBuf with the binary bytes from stdin
 
@@ -269,7 +272,7 @@ private:
       @brief Default constructor. Note that optstring_ is initialized here.
              The c'tor is private to force instantiation through instance().
      */
-    Params() : optstring_(":hVvqfbuktTFa:Y:O:D:r:p:P:d:e:i:c:m:M:l:S:g:K:n:Q:"),
+    Params() : optstring_(":hVvqfbuktTFa:Y:O:D:r:p:P:d:e:i:c:m:M:l:S:g:K:n:Q:j:"),
                help_(false),
                version_(false),
                verbose_(false),
@@ -289,6 +292,7 @@ private:
                adjustment_(0),
                format_("%Y%m%d_%H%M%S"),
                formatSet_(false),
+               jobs_(1),
                first_(true)
     {
         yodAdjust_[yodYear]  = emptyYodAdjust_[yodYear];
@@ -310,6 +314,7 @@ private:
     int evalExtract(const std::string& optarg);
     int evalInsert(const std::string& optarg);
     int evalModify(int opt, const std::string& optarg);
+    int evalJobs(const std::string& optarg);
     //@}
 
 public:
@@ -70,21 +70,31 @@
 #endif
 
 namespace Exiv2 {
-    constexpr std::array<const char*, 2> ENVARDEF{
+    constexpr std::array<const char*, 7> ENVARDEF{
         "/exiv2.php",
         "40",
-    };  //!< @brief default URL for http exiv2 handler and time-out
-    constexpr std::array<const char*, 2> ENVARKEY{
+        "",
+        "64",
+        "0",
+        "",
+        "1",
+    };  //!< @brief default URL for http exiv2 handler, time-out, remote block cache directory and size (MB), atomic writes, structure index directory, TIFF decoder threads
+    constexpr std::array<const char*, 7> ENVARKEY{
         "EXIV2_HTTP_POST",
         "EXIV2_TIMEOUT",
-    };  //!< @brief request keys for http exiv2 handler and time-out
+        "EXIV2_REMOTE_CACHE",
+        "EXIV2_REMOTE_CACHE_SIZE",
+        "EXIV2_ATOMIC_WRITE",
+        "EXIV2_INDEX_CACHE",
+        "EXIV2_DECODE_THREADS",
+    };  //!< @brief request keys for http exiv2 handler, time-out, remote block cache directory and size (MB), atomic writes, structure index directory, TIFF decoder threads
 
     // *****************************************************************************
     // free functions
     std::string getEnv(int env_var)
     {
         // this check is relying on undefined behavior and might not be effective
-        if (env_var < envHTTPPOST || env_var > envTIMEOUT) {
+        if (env_var < envHTTPPOST || env_var > envDECODETHREADS) {
             throw std::out_of_range("Unexpected env variable");
         }
         return getenv(ENVARKEY[env_var]) ? getenv(ENVARKEY[env_var]) : ENVARDEF[env_var];
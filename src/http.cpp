@@ -30,14 +30,20 @@
 
 #include <sys/types.h>
 #include <stdio.h>
+#include <algorithm>
 #include <array>
+#include <cctype>
 #include <cstdlib>
+#include <map>
+#include <mutex>
 #include <time.h>
 #include <sys/stat.h>
 #include <string.h>
 
 #define SLEEP       1000
 #define SNOOZE         0
+#define TIMEOUT       30 // seconds, for persistent connections
+#define POOLMAX        4 // idle connections per server
 
 #ifdef  __MINGW__
 #define  fopen_S(f,n,a)  f=fopen(n,a)
@@ -174,6 +180,43 @@ static Exiv2::Dictionary stringToDict(const std::string& s)
     return result;
 }
 
+// find the server and port to connect to and the page to request
+static void route(Exiv2::Dictionary& request, std::string& server, std::string& port, std::string& page)
+{
+    server = request["server"];
+    port   = request["port"  ];
+    page   = request["page"  ];
+    std::string url = std::string("http://") + request["server"] + request["page"];
+
+    // parse and change server if using a proxy
+    const char* PROXI  = "HTTP_PROXY";
+    const char* proxi  = "http_proxy";
+    const char* PROXY  = getenv(PROXI);
+    const char* proxy  = getenv(proxi);
+    bool        bProx  = PROXY || proxy;
+    const char* prox   = bProx ? (proxy?proxy:PROXY):"";
+    Exiv2::Uri  Proxy  =  Exiv2::Uri::Parse(prox);
+
+    // find the dictionary of no_proxy servers
+    const char* NO_PROXI = "NO_PROXY";
+    const char* no_proxi = "no_proxy";
+    const char* NO_PROXY = getenv(NO_PROXI);
+    const char* no_proxy = getenv(no_proxi);
+    bool        bNoProxy = NO_PROXY||no_proxy;
+    std::string no_prox  = std::string(bNoProxy?(no_proxy?no_proxy:NO_PROXY):"");
+    Exiv2::Dictionary noProxy= stringToDict(no_prox + ",localhost,127.0.0.1");
+
+    // if the server is on the no_proxy list ... ignore the proxy!
+    if ( noProxy.count(server) ) bProx = false;
+
+    if (  bProx ) {
+        server = Proxy.Host;
+        port   = Proxy.Port;
+        page   = url;
+    }
+    if ( port.empty() ) port = "80";
+}
+
 static int makeNonBlocking(int sockfd)
 {
 #ifdef   WIN32
@@ -210,40 +253,12 @@ int Exiv2::http(Exiv2::Dictionary& request,Exiv2::Dictionary& response,std::stri
     const char* version    = request["version"].c_str();
     const char* port       = request["port"   ].c_str();
 
-    const char* servername_p = servername;
-    const char* port_p       = port      ;
-    std::string url = std::string("http://") + request["server"] + request["page"];
-
-    // parse and change server if using a proxy
-    const char* PROXI  = "HTTP_PROXY";
-    const char* proxi  = "http_proxy";
-    const char* PROXY  = getenv(PROXI);
-    const char* proxy  = getenv(proxi);
-    bool        bProx  = PROXY || proxy;
-    const char* prox   = bProx ? (proxy?proxy:PROXY):"";
-    Exiv2::Uri  Proxy  =  Exiv2::Uri::Parse(prox);
-
-    // find the dictionary of no_proxy servers
-    const char* NO_PROXI = "NO_PROXY";
-    const char* no_proxi = "no_proxy";
-    const char* NO_PROXY = getenv(NO_PROXI);
-    const char* no_proxy = getenv(no_proxi);
-    bool        bNoProxy = NO_PROXY||no_proxy;
-    std::string no_prox  = std::string(bNoProxy?(no_proxy?no_proxy:NO_PROXY):"");
-    Exiv2::Dictionary noProxy= stringToDict(no_prox + ",localhost,127.0.0.1");
-
-    // if the server is on the no_proxy list ... ignore the proxy!
-    if ( noProxy.count(servername) ) bProx = false;
-
-    if (  bProx ) {
-        servername_p = Proxy.Host.c_str();
-        port_p       = Proxy.Port.c_str();
-        page         = url.c_str();
-        std::string  p(proxy?proxi:PROXI);
-    //  std::cerr << p << '=' << prox << " page = " << page << std::endl;
-    }
+    std::string server_r, port_r, page_r;
+    route(request, server_r, port_r, page_r);
+    const char* servername_p = server_r.c_str();
+    const char* port_p       = port_r.c_str();
+    page                     = page_r.c_str();
     if ( !port  [0] ) port   = "80";
-    if ( !port_p[0] ) port_p = "80";
 
     ////////////////////////////////////
     // open the socket
@@ -410,4 +425,286 @@ int Exiv2::http(Exiv2::Dictionary& request,Exiv2::Dictionary& response,std::stri
     return result;
 }
 
+////////////////////////////////////////
+// persistent connections
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// idle keep-alive connections, by server:port
+static std::mutex                      poolMutex;
+static std::multimap<std::string, int> pool;
+
+static int takeConnection(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = pool.find(key);
+    if ( it == pool.end() ) return -1;
+    int sockfd = it->second;
+    pool.erase(it);
+    return sockfd;
+}
+
+static void giveConnection(const std::string& key, int sockfd)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if ( pool.count(key) < POOLMAX ) {
+        pool.emplace(key, sockfd);
+    } else {
+        closesocket(sockfd);
+    }
+}
+
+static int connectTo(const std::string& server, const std::string& port, std::string& errors)
+{
+    int sockfd = static_cast<int>(socket(AF_INET , SOCK_STREAM,IPPROTO_TCP));
+    if (sockfd < 0)
+        return error(errors, "unable to create socket\n", nullptr, nullptr, 0);
+
+    struct  sockaddr_in serv_addr   ;
+    int                 serv_len = sizeof(serv_addr);
+    memset(reinterpret_cast<char*>(&serv_addr), 0, serv_len);
+
+    serv_addr.sin_addr.s_addr   = inet_addr(server.c_str());
+    serv_addr.sin_family        = AF_INET    ;
+    serv_addr.sin_port          = htons(atoi(port.c_str()));
+
+    if (serv_addr.sin_addr.s_addr == static_cast<unsigned long>(INADDR_NONE)) {
+        struct hostent* host = gethostbyname(server.c_str());
+        if (!host) {
+            closesocket(sockfd);
+            return error(errors, "no such host", server.c_str());
+        }
+        memcpy(&serv_addr.sin_addr, host->h_addr, sizeof(serv_addr.sin_addr));
+    }
+
+    // blocking socket with timeouts
+#if defined(WIN32) || defined(_MSC_VER) || defined(__MINGW__)
+    DWORD timeout = TIMEOUT * 1000;
+#else
+    struct timeval timeout = { TIMEOUT, 0 };
+#endif
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof timeout);
+    setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof timeout);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof on);
+#endif
+
+    if ( connect(sockfd, reinterpret_cast<const struct sockaddr*>(&serv_addr), serv_len) == SOCKET_ERROR ) {
+        int err = WSAGetLastError();
+        closesocket(sockfd);
+        return error(errors, "error - unable to connect to server = %s port = %s wsa_error = %d", server.c_str(),
+                     port.c_str(), err);
+    }
+    return sockfd;
+}
+
+static bool sendAll(int sockfd, const std::string& data)
+{
+    size_t sent = 0;
+    while ( sent < data.size() ) {
+        int n = send(sockfd, data.data() + sent, static_cast<int>(data.size() - sent), MSG_NOSIGNAL);
+        if ( n <= 0 ) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// append the next data from the socket to buffer, false if the connection is closed or broken
+static bool receive(int sockfd, std::string& buffer)
+{
+    char chunk[32*1024];
+    int  n = recv(sockfd, chunk, sizeof chunk, 0);
+    if ( n <= 0 ) return false;
+    buffer.append(chunk, n);
+    return true;
+}
+
+static std::string lower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(::tolower(c)); });
+    return s;
+}
+
+// read one response from the connection, data received beyond it stays in buffer
+// returns the status or -1 if the connection was closed or the response is invalid
+static int readResponse(int sockfd, std::string& buffer, bool head, Exiv2::Dictionary& response, bool& keepAlive)
+{
+    size_t eoh;
+    while ( (eoh = buffer.find("\r\n\r\n")) == std::string::npos ) {
+        if ( buffer.size() > 64*1024 || !receive(sockfd, buffer) ) return -1;
+    }
+    const std::string headers = buffer.substr(0, eoh + 2);
+    buffer.erase(0, eoh + 4);
+
+    // status line
+    size_t eol   = headers.find("\r\n");
+    size_t space = headers.find(' ');
+    if ( headers.compare(0, 5, "HTTP/") != 0 || space > eol ) return -1;
+    response[""] = headers.substr(0, eol);
+    int  status  = atoi(headers.c_str() + space);
+    keepAlive    = headers.compare(0, space, "HTTP/1.1") == 0;
+
+    // headers
+    long contentLength = -1;
+    bool chunked       = false;
+    for ( size_t pos = eol + 2; pos < headers.size(); pos = eol + 2 ) {
+        eol = headers.find("\r\n", pos);
+        size_t colon = headers.find(':', pos);
+        if ( colon > eol ) continue;
+        size_t      start = std::min(headers.find_first_not_of(" \t", colon + 1), eol);
+        std::string key   = headers.substr(pos, colon - pos);
+        std::string value = headers.substr(start, eol - start);
+        response[key] = value;
+
+        key = lower(key);
+        if ( key == "content-length" ) {
+            contentLength = atol(value.c_str());
+        } else if ( key == "transfer-encoding" ) {
+            chunked = lower(value).find("chunked") != std::string::npos;
+        } else if ( key == "connection" ) {
+            value = lower(value);
+            if ( value.find("close")      != std::string::npos ) keepAlive = false;
+            if ( value.find("keep-alive") != std::string::npos ) keepAlive = true;
+        }
+    }
+
+    // body
+    std::string body;
+    if ( head || status / 100 == 1 || status == 204 || status == 304 ) {
+        // no body
+    } else if ( chunked ) {
+        for (;;) {
+            while ( (eol = buffer.find("\r\n")) == std::string::npos ) {
+                if ( !receive(sockfd, buffer) ) return -1;
+            }
+            long size = strtol(buffer.c_str(), nullptr, 16);
+            buffer.erase(0, eol + 2);
+            if ( size <= 0 ) break;
+            while ( buffer.size() < static_cast<size_t>(size) + 2 ) {
+                if ( !receive(sockfd, buffer) ) return -1;
+            }
+            body.append(buffer, 0, size);
+            buffer.erase(0, size + 2);
+        }
+        // skip the trailer
+        while ( (eol = buffer.find("\r\n")) != 0 ) {
+            if ( eol != std::string::npos ) {
+                buffer.erase(0, eol + 2);
+            } else if ( !receive(sockfd, buffer) ) {
+                return -1;
+            }
+        }
+        buffer.erase(0, 2);
+    } else if ( contentLength >= 0 ) {
+        while ( buffer.size() < static_cast<size_t>(contentLength) ) {
+            if ( !receive(sockfd, buffer) ) return -1;
+        }
+        body = buffer.substr(0, contentLength);
+        buffer.erase(0, contentLength);
+    } else {
+        // the body ends when the server closes the connection
+        while ( receive(sockfd, buffer) ) {}
+        body.swap(buffer);
+        keepAlive = false;
+    }
+    response["body"] = body;
+    return status;
+}
+
+int Exiv2::http(std::vector<Exiv2::Dictionary>& requests,std::vector<Exiv2::Dictionary>& responses,std::string& errors)
+{
+    errors = "";
+    responses.assign(requests.size(), Exiv2::Dictionary());
+    if ( requests.empty() ) return -1;
+
+#if defined(WIN32) || defined(_MSC_VER) || defined(__MINGW__) || defined(__CYGWIN__)
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2,2), &wsaData);
+#endif
+
+    std::string server, port, page;
+    route(requests.front(), server, port, page);
+    const std::string key = server + ':' + port;
+
+    // format the requests
+    std::vector<std::string> messages;
+    char   buffer[32*1024+1];
+    for ( size_t i = 0; i < requests.size(); i++ ) {
+        Exiv2::Dictionary& request = requests[i];
+        if ( !request.count("verb")   ) request["verb"  ] = "GET";
+        if ( !request.count("header") ) request["header"] = ""   ;
+        request["version"] = "1.1";
+        std::string s, p;
+        route(request, s, p, page);
+        std::string host = request["server"];
+        if ( !request["port"].empty() ) host += ':' + request["port"];
+        int n = snprintf(buffer, sizeof buffer, httpTemplate, request["verb"].c_str(), page.c_str(), "1.1",
+                         host.c_str(), request["header"].c_str());
+        if ( n < 0 || n >= static_cast<int>(sizeof buffer) )
+            return error(errors, "error - request too long for server = %s", server.c_str());
+        messages.emplace_back(buffer, n);
+        responses[i]["requestheaders"] = messages.back();
+        if ( request.count("body") ) messages.back() += request["body"];
+    }
+
+    // only GET and HEAD are sent again when a connection fails, other
+    // requests are sent on their own on a new connection and never retried
+    std::vector<bool> idempotent;
+    for ( auto&& request : requests ) {
+        idempotent.push_back(request["verb"] == "GET" || request["verb"] == "HEAD");
+    }
+
+    int    result = -1;
+    size_t done   = 0; // number of responses received
+    while ( done < requests.size() ) {
+        bool pooled = idempotent[done];
+        int  sockfd = pooled ? takeConnection(key) : -1;
+        if ( sockfd < 0 ) {
+            pooled = false;
+            sockfd = connectTo(server, port, errors);
+            if ( sockfd < 0 ) return -1;
+        }
+
+        // pipeline the requests once the connection is known to persist,
+        // on a new connection wait for the first response
+        std::string data;
+        bool   keepAlive = true;
+        size_t received  = 0;
+        size_t sent      = done;
+        while ( keepAlive && done < requests.size() ) {
+            if ( sent == done ) {
+                size_t last = pooled || received ? requests.size() : done + 1;
+                std::string batch;
+                for ( ; sent < last && (sent == done || (idempotent[done] && idempotent[sent])); sent++ ) {
+                    batch += messages[sent];
+                }
+                if ( !sendAll(sockfd, batch) ) break;
+            }
+            bool head   = requests[done]["verb"] == "HEAD";
+            int  status = readResponse(sockfd, data, head, responses[done], keepAlive);
+            if ( status < 0 ) break;
+            if ( result < 0 || OK(result) ) result = status;
+            done++;
+            received++;
+        }
+
+        if ( keepAlive && done == requests.size() && data.empty() ) {
+            giveConnection(key, sockfd);
+        } else {
+            closesocket(sockfd);
+        }
+        if ( sent > done && !idempotent[done] )
+            return error(errors, "error - no response to %s request from server = %s, not sent again",
+                         requests[done]["verb"].c_str(), server.c_str());
+        // a pooled connection may have been closed by the server, retry on a new one
+        if ( !received && !pooled )
+            return error(errors, "error - no response from server = %s port = %s wsa_error = %d", server.c_str(),
+                         port.c_str(), WSAGetLastError());
+    }
+    return result;
+}
+
 // That's all Folks
@@ -573,8 +573,8 @@ namespace Exiv2 {
 
     std::string& Image::xmpPacket()
     {
-        // Serialize the current XMP
-        if (xmpData_.count() > 0 && !writeXmpFromPacket()) {
+        // Serialize the current XMP, this decodes a deferred packet
+        if (!writeXmpFromPacket_ && xmpData_.count() > 0) {
             XmpParser::encode(xmpPacket_, xmpData_,
                               XmpParser::useCompactFormat |
                               XmpParser::omitAllFormatting);
@@ -739,7 +739,9 @@ namespace Exiv2 {
 
     bool Image::writeXmpFromPacket() const
     {
-        return writeXmpFromPacket_;
+        // Pass the packet through if the XMP metadata was never accessed,
+        // unless it was copied from another image and has another packet
+        return writeXmpFromPacket_ || (xmpData_.decodePending() && xmpPacket_ == xmpData_.xmpPacket());
     }
 
     const NativePreviewList& Image::nativePreviews() const
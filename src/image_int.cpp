@@ -17,13 +17,56 @@
  * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "config.h"
 #include "image_int.hpp"
+#include "basicio.hpp"
+#include "error.hpp"
+#include "futils.hpp"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 #include <vector>
 #include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef EXV_HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+namespace
+{
+    /*!
+      @brief Return true if the file can be replaced by renaming another file
+             to its path without a visible difference: a regular file with
+             one link which belongs to the user and group of the process.
+     */
+    bool canReplace(const std::string& path)
+    {
+#if defined(EXV_HAVE_UNISTD_H) && !defined(EXV_UNICODE_PATH)
+        struct stat buf;
+        return ::lstat(path.c_str(), &buf) == 0 && S_ISREG(buf.st_mode)
+            && buf.st_nlink == 1 && buf.st_uid == ::geteuid() && buf.st_gid == ::getegid();
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    //! Temporary file which is removed with the IO, unless it has been renamed
+    class TempFileIo : public Exiv2::FileIo
+    {
+    public:
+        explicit TempFileIo(const std::string& path) : FileIo(path) {}
+        ~TempFileIo() override
+        {
+            close();
+            std::remove(path().c_str());
+        }
+    };
+}
 
 namespace Exiv2
 {
@@ -112,6 +155,70 @@ namespace Exiv2
             return result;
         }
 
+        size_t findBytes(const byte* data, size_t start, size_t size, const std::string& needle)
+        {
+            if (needle.empty() || needle.size() > size) return size;
+            const size_t last = size - needle.size();
+            for (size_t pos = start; pos <= last; pos++) {
+                auto p = static_cast<const byte*>(std::memchr(data + pos, needle[0], last - pos + 1));
+                if (p == nullptr) break;
+                pos = p - data;
+                if (std::memcmp(p + 1, needle.data() + 1, needle.size() - 1) == 0) return pos;
+            }
+            return size;
+        }
+
+        size_t findEither(const byte* data, size_t start, size_t size, byte a, byte b)
+        {
+            // Small windows keep a rare byte from being searched far beyond a frequent one
+            const size_t window = 256;
+            for (size_t pos = start; pos < size; pos += window) {
+                const size_t count = std::min(window, size - pos);
+                auto p = static_cast<const byte*>(std::memchr(data + pos, a, count));
+                const size_t countB = p ? p - (data + pos) : count;
+                auto q = static_cast<const byte*>(std::memchr(data + pos, b, countB));
+                if (q) return q - data;
+                if (p) return p - data;
+            }
+            return size;
+        }
+
+        void copyIo(BasicIo& src, BasicIo& dest, size_t size)
+        {
+            auto fileIo = dynamic_cast<FileIo*>(&dest);
+            if (fileIo && size <= static_cast<size_t>(std::numeric_limits<long>::max())) {
+                const long pos = src.tell();
+                if (pos < 0 || src.size() < pos + size)
+                    throw Error(kerInputDataReadFailed);
+                if (fileIo->write(src, static_cast<long>(size)) != static_cast<long>(size))
+                    throw Error(kerImageWriteFailed);
+                return;
+            }
+            DataBuf buf(static_cast<long>(std::min(size, copyIoBufferSize)));
+            while (size > 0) {
+                const long count = static_cast<long>(std::min(size, static_cast<size_t>(buf.size())));
+                if (src.read(buf.data(), count) != count || src.error())
+                    throw Error(kerInputDataReadFailed);
+                if (dest.write(buf.c_data(), count) != count)
+                    throw Error(kerImageWriteFailed);
+                size -= static_cast<size_t>(count);
+            }
+        }
+
+        std::unique_ptr<BasicIo> createTempIo(BasicIo& io)
+        {
+            if (dynamic_cast<FileIo*>(&io) && io.size() >= tempFileThreshold && canReplace(io.path())) {
+                for (int i = 0; i < 100; i++) {
+                    const std::string path = io.path() + ".exiv2_temp" + std::to_string(i);
+                    if (fileExists(path)) continue;
+                    std::unique_ptr<TempFileIo> tempIo(new TempFileIo(path));
+                    if (tempIo->open("w+b") == 0) return std::unique_ptr<BasicIo>(tempIo.release());
+                    break;
+                }
+            }
+            return std::unique_ptr<BasicIo>(new MemIo);
+        }
+
     }  // namespace Internal
 
 }  // namespace Exiv2
@@ -25,6 +25,7 @@
 #include "types.hpp"
 
 // + standard includes
+#include <memory>
 #include <string>
 
 #if (defined(__GNUG__) || defined(__GNUC__)) || defined(__clang__)
@@ -36,6 +37,8 @@
 // *****************************************************************************
 // namespace extensions
 namespace Exiv2 {
+    class BasicIo;
+
     namespace Internal {
 
 // *****************************************************************************
@@ -130,6 +133,52 @@ namespace Exiv2 {
      */
     std::string indent(int32_t depth);
 
+    /*!
+      @brief Find the first occurrence of \em needle in the range [\em start,
+             \em size) of \em data. memchr(), which the C libraries implement
+             with vector instructions, skips to the candidates for the first
+             byte of \em needle.
+      @return The position of the occurrence, \em size if there is none.
+     */
+    size_t findBytes(const byte* data, size_t start, size_t size, const std::string& needle);
+
+    /*!
+      @brief Find the first byte in the range [\em start, \em size) of
+             \em data which is \em a or \em b, with memchr() in windows of a
+             few hundred bytes.
+      @return The position of the byte, \em size if there is none.
+     */
+    size_t findEither(const byte* data, size_t start, size_t size, byte a, byte b);
+
+    //! Size of the buffer used by copyIo()
+    const size_t copyIoBufferSize = 64 * 1024;
+
+    /*!
+      @brief Copy \em size bytes from the current position of \em src to
+             \em dest, through a buffer of at most copyIoBufferSize bytes.
+             A file \em dest copies the data itself, see FileIo::write(BasicIo&, long).
+      @throw Error if the data cannot be read or written.
+     */
+    void copyIo(BasicIo& src, BasicIo& dest, size_t size);
+
+    //! Size from which createTempIo() stages the output in a file
+    const size_t tempFileThreshold = 1024 * 1024;
+
+    /*!
+      @brief Create the IO to which a modified copy of \em io is written
+             before it is passed to io.transfer().
+
+      For a FileIo of at least tempFileThreshold bytes, this is a temporary
+      file in the same directory, which transfer() renames to the original,
+      so that the size of the file does not limit the size of the memory.
+      This is only done for regular files of the user without other links,
+      which are not changed otherwise by the rename.
+      The temporary file is removed when the IO is destroyed, if it still
+      exists. Otherwise, and if the temporary file cannot be created, this
+      is a MemIo.
+     */
+    std::unique_ptr<BasicIo> createTempIo(BasicIo& io);
+
 }}                                      // namespace Internal, Exiv2
 
 #endif                                  // #ifndef IMAGE_INT_HPP_
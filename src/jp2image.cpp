@@ -35,6 +35,7 @@
 #include "safe_op.hpp"
 
 // + standard includes
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <iostream>
@@ -442,11 +443,7 @@ static void boxes_check(size_t b,size_t m)
                                 xmpPacket_ = xmpPacket_.substr(idx);
                            }
 
-                            if (!xmpPacket_.empty() && XmpParser::decode(xmpData_, xmpPacket_)) {
-#ifndef SUPPRESS_WARNINGS
-                                EXV_WARNING << "Failed to decode XMP metadata." << std::endl;
-#endif
-                            }
+                            xmpData_.setPacketDeferred(xmpPacket_);
                         }
                     }
                     break;
@@ -638,7 +635,7 @@ static void boxes_check(size_t b,size_t m)
             throw Error(kerDataSourceOpenFailed, io_->path(), strError());
         }
         IoCloser closer(*io_);
-        BasicIo::UniquePtr tempIo(new MemIo);
+        BasicIo::UniquePtr tempIo = Internal::createTempIo(*io_);
         assert (tempIo.get() != 0);
 
         doWriteMetadata(*tempIo); // may throw
@@ -802,24 +799,29 @@ static void boxes_check(size_t b,size_t m)
             // Prevent a malicious file from causing a large memory allocation.
             enforce(box.length - 8 <= static_cast<size_t>(io_->size() - io_->tell()), kerCorruptedMetadata);
 
-            // Read whole box : Box header + Box data (not fixed size - can be null).
-            DataBuf boxBuf(box.length);                             // Box header (8 bytes) + box data.
-            boxBuf.copyBytes(0, bheaderBuf.c_data(), 8);        // Copy header.
-            bufRead = io_->read(boxBuf.data(8), box.length - 8); // Extract box data.
-            if (io_->error())
-            {
+            // Only the JP2 header box and the start of UUID boxes are read,
+            // other boxes like the codestream are copied.
+            DataBuf boxBuf;                                         // Box header (8 bytes) + box data.
+            if (box.type == kJp2BoxTypeJp2Header || box.type == kJp2BoxTypeUuid) {
+                const uint32_t length = box.type == kJp2BoxTypeUuid ? std::min(box.length, 24U) : box.length;
+                boxBuf.alloc(length);
+                boxBuf.copyBytes(0, bheaderBuf.c_data(), 8);        // Copy header.
+                bufRead = io_->read(boxBuf.data(8), length - 8);    // Extract box data.
+                if (io_->error())
+                {
 #ifdef EXIV2_DEBUG_MESSAGES
-                std::cout << "Exiv2::Jp2Image::doWriteMetadata: Error reading source file" << std::endl;
+                    std::cout << "Exiv2::Jp2Image::doWriteMetadata: Error reading source file" << std::endl;
 #endif
 
-                throw Error(kerFailedToReadImageData);
-            }
+                    throw Error(kerFailedToReadImageData);
+                }
 
-            if (bufRead != static_cast<long>(box.length - 8)) {
+                if (bufRead != static_cast<long>(length - 8)) {
 #ifdef EXIV2_DEBUG_MESSAGES
-                std::cout << "Exiv2::Jp2Image::doWriteMetadata: Cannot read source file data" << std::endl;
+                    std::cout << "Exiv2::Jp2Image::doWriteMetadata: Cannot read source file data" << std::endl;
 #endif
-                throw Error(kerInputDataReadFailed);
+                    throw Error(kerInputDataReadFailed);
+                }
             }
 
             switch(box.type)
@@ -917,6 +919,7 @@ static void boxes_check(size_t b,size_t m)
                 case kJp2BoxTypeUuid:
                 {
                     enforce(boxBuf.size() >= 24, Exiv2::kerCorruptedMetadata);
+                    const long rest = static_cast<long>(box.length) - boxBuf.size();
                     if (boxBuf.cmpBytes(8, kJp2UuidExif, 16) == 0)
                     {
 #ifdef EXIV2_DEBUG_MESSAGES
@@ -941,7 +944,10 @@ static void boxes_check(size_t b,size_t m)
                         std::cout << "Exiv2::Jp2Image::doWriteMetadata: write Uuid box (length: " << box.length << ")" << std::endl;
 #endif
                         if (outIo.write(boxBuf.c_data(), boxBuf.size()) != boxBuf.size()) throw Error(kerImageWriteFailed);
+                        Internal::copyIo(*io_, outIo, rest);
+                        break;
                     }
+                    io_->seek(rest, BasicIo::cur);
                     break;
                 }
 
@@ -950,7 +956,8 @@ static void boxes_check(size_t b,size_t m)
 #ifdef EXIV2_DEBUG_MESSAGES
                     std::cout << "Exiv2::Jp2Image::doWriteMetadata: write box (length: " << box.length << ")" << std::endl;
 #endif
-                    if (outIo.write(boxBuf.c_data(), boxBuf.size()) != boxBuf.size()) throw Error(kerImageWriteFailed);
+                    if (outIo.write(bheaderBuf.c_data(), bheaderBuf.size()) != bheaderBuf.size()) throw Error(kerImageWriteFailed);
+                    Internal::copyIo(*io_, outIo, box.length - 8);
 
                     break;
                 }
@@ -394,6 +394,9 @@ namespace Exiv2 {
                 // `size` is the size of the segment, including the 2-byte size field
                 // that we just read.
                 enforce(size >= 2, kerFailedToReadImageData);
+                // The next marker and segment size follow this segment, let
+                // remote IO fetch them together with it
+                io_->prefetch(io_->tell() + size - 2, 4);
             }
 
             // Read the rest of the segment.
@@ -423,11 +426,7 @@ namespace Exiv2 {
                      && size >= 31  // prevent out-of-bounds read in memcmp on next line
                      && buf.cmpBytes(2, xmpId_, 29) == 0) {
                 xmpPacket_.assign(buf.c_str(31), size - 31);
-                if (!xmpPacket_.empty() && XmpParser::decode(xmpData_, xmpPacket_)) {
-#ifndef SUPPRESS_WARNINGS
-                    EXV_WARNING << "Failed to decode XMP metadata.\n";
-#endif
-                }
+                xmpData_.setPacketDeferred(xmpPacket_);
                 --search;
                 foundXmpData = true;
             }
@@ -662,17 +661,12 @@ namespace Exiv2 {
                         // and dumping the XMP in a post read operation similar to kpsIptcErase
                         // for the moment, dumping 'on the fly' is working fine
                         if (!bExtXMP) {
-                            while (start < size && xmp[start]) {
-                                start++;
-                            }
-                            start++;
-                            if (start < size) {
-                                const std::string xmp_from_start =
-                                    string_from_unterminated(&xmp[start], size - start);
-                                if (xmp_from_start.find("HasExtendedXMP", start) != std::string::npos) {
-                                    start = size;  // ignore this packet, we'll get on the next time around
-                                    bExtXMP = true;
-                                }
+                            // the packet follows the NUL which ends the signature
+                            start = Internal::findBytes(buf.c_data(), start, size, std::string(1, '\0')) + 1;
+                            if (start < size &&
+                                Internal::findBytes(buf.c_data(), start, size, "HasExtendedXMP") != size) {
+                                start = size;  // ignore this packet, we'll get on the next time around
+                                bExtXMP = true;
                             }
                         } else {
                             start = 2 + 35 + 32 + 4 + 4;  // Adobe Spec, p19
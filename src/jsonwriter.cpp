@@ -0,0 +1,522 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+  File:      jsonwriter.cpp
+ */
+// *****************************************************************************
+// included header files
+#include "config.h"
+
+#include "jsonwriter.hpp"
+#include "error.hpp"
+#include "exif.hpp"
+#include "image.hpp"
+#include "iptc.hpp"
+#include "properties.hpp"
+#include "value.hpp"
+#include "xmp_exiv2.hpp"
+
+// + standard includes
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// *****************************************************************************
+// local declarations
+namespace {
+
+    using namespace Exiv2;
+
+    //! One component of a metadata key, as split by the exiv2json sample
+    struct Token {
+        std::string n;                      //!< Name, e.g. "History"
+        bool        a;                      //!< Name is an array, e.g. "History[]"
+        int         i;                      //!< Array index (from 1), e.g. "History[1]"
+        bool        ns;                     //!< Name is a namespace prefix following a '/'
+    };
+    using Tokens = std::vector<Token>;
+
+    /*!
+      @brief Split a key into its components. For example,
+             "Xmp.xmpMM.History[1]/stEvt:action" is split into
+             "Xmp", "xmpMM", "History" (array), "1" (index), "stEvt" and
+             "action".
+     */
+    void tokenize(const std::string& key, Tokens& tokens);
+
+    //! Return the rank of the first appearance of \em group in \em groups
+    size_t groupRank(std::vector<std::string>& groups, const std::string& group);
+
+    /*!
+      @brief Writes JSON text into a buffer while metadata is added. Keeps
+             the stack of the currently open objects and arrays.
+     */
+    class Emitter {
+    public:
+        //! Constructor, \em indent is the number of levels the text is indented by
+        Emitter(bool pretty, size_t indent);
+
+        //! Open the root object and add the "path" member, if not empty
+        void begin(const std::string& path);
+        //! Add the metadata of one family, e.g., ExifData
+        template<typename Data>
+        void add(const Data& data);
+        //! Close all open containers and the root object
+        void end();
+        //! The JSON text written so far
+        const std::string& text() const { return buf_; }
+
+    private:
+        //! An open object or array
+        struct Level {
+            std::string name;               //!< Name of the token which opened the level
+            bool        array;              //!< True for an array, false for an object
+            size_t      count;              //!< Number of members or elements
+        };
+
+        //! Add one metadatum, given the tokens of its key
+        void add(const Metadatum& md);
+        //! Add the "xmlns" member with the namespaces used to the "Xmp" object
+        void addNamespaces();
+        //! Open the container for token \em t in the current level
+        void open(const Token& t);
+        //! Close levels until \em depth levels are left
+        void close(size_t depth);
+        //! Start a new member (if in an object) or element (if in an array)
+        void item(const std::string& name);
+        //! Add the separator before a new member or element
+        void separator();
+        //! Write the value of a metadatum
+        void value(const Metadatum& md, const std::string& name);
+        //! Write a quoted and escaped string
+        void quoted(const std::string& s);
+        /*!
+          @brief Write the space separated numbers of \em s, as a number if
+                 there is one component, else as an array.
+         */
+        void numbers(const std::string& s, long count);
+        /*!
+          @brief Write a single number, null if it is not finite. Rationals
+                 are written as [numerator, denominator].
+         */
+        void number(const char* begin, const char* end);
+
+        // DATA
+        bool pretty_;                       //!< Indented output
+        size_t indent_;                     //!< Number of levels of the root object
+        std::string buf_;                   //!< JSON text
+        std::vector<Level> levels_;         //!< Open objects and arrays
+        Tokens tokens_;                     //!< Tokens of the current key
+        std::set<std::string> namespaces_;  //!< XMP namespace prefixes seen
+
+    }; // class Emitter
+
+}
+
+// *****************************************************************************
+// class member definitions
+namespace Exiv2 {
+
+    JsonWriter::JsonWriter(std::ostream& os, Format format)
+        : os_(os), format_(format)
+    {
+    }
+
+    void JsonWriter::write(const Image& image, const std::string& path, int metadataTypes)
+    {
+        Emitter emitter(format_ == json, array_ ? 1 : 0);
+        emitter.begin(path);
+        if (metadataTypes & mdExif) emitter.add(image.exifData());
+        if (metadataTypes & mdIptc) emitter.add(image.iptcData());
+        if (metadataTypes & mdXmp)  emitter.add(image.xmpData());
+        emitter.end();
+        writeObject(emitter.text());
+    }
+
+    void JsonWriter::write(const ExifData& exifData,
+                           const IptcData& iptcData,
+                           const XmpData& xmpData,
+                           const std::string& path)
+    {
+        Emitter emitter(format_ == json, array_ ? 1 : 0);
+        emitter.begin(path);
+        emitter.add(exifData);
+        emitter.add(iptcData);
+        emitter.add(xmpData);
+        emitter.end();
+        writeObject(emitter.text());
+    }
+
+    void JsonWriter::beginArray()
+    {
+        if (format_ != json || array_) return;
+        os_ << '[';
+        array_ = true;
+        count_ = 0;
+    }
+
+    void JsonWriter::endArray()
+    {
+        if (!array_) return;
+        os_ << (count_ > 0 ? "\n]\n" : "]\n");
+        array_ = false;
+    }
+
+    void JsonWriter::writeObject(const std::string& text)
+    {
+        if (array_) {
+            os_ << (count_++ > 0 ? ",\n    " : "\n    ");
+        }
+        os_.write(text.data(), text.size());
+        if (!array_) os_ << '\n';
+    }
+
+}                                       // namespace Exiv2
+
+// *****************************************************************************
+// local definitions
+namespace {
+
+    void tokenize(const std::string& key, Tokens& tokens)
+    {
+        tokens.clear();
+        Token t = { std::string(), false, 0, false };
+        for (auto&& c : key) {
+            if (c == '/' || c == '[' || c == ':' || c == '.' || c == ']') {
+                if (!t.n.empty()) {
+                    t.a = c == '[';
+                    if (c == ']') t.i = std::atoi(t.n.c_str());
+                    tokens.push_back(t);
+                    t.n.clear();
+                    t.a = false;
+                    t.i = 0;
+                    t.ns = false;
+                }
+                t.ns |= c == '/';
+            }
+            else {
+                t.n += c;
+            }
+        }
+        if (!t.n.empty()) tokens.push_back(t);
+    }
+
+    size_t groupRank(std::vector<std::string>& groups, const std::string& group)
+    {
+        auto i = std::find(groups.begin(), groups.end(), group);
+        if (i != groups.end()) return i - groups.begin();
+        groups.push_back(group);
+        return groups.size() - 1;
+    }
+
+    Emitter::Emitter(bool pretty, size_t indent)
+        : pretty_(pretty), indent_(pretty ? indent : 0)
+    {
+    }
+
+    void Emitter::begin(const std::string& path)
+    {
+        buf_ += '{';
+        levels_.push_back({ std::string(), false, 0 });
+        if (!path.empty()) {
+            item("path");
+            quoted(path);
+        }
+    }
+
+    template<typename Data>
+    void Emitter::add(const Data& data)
+    {
+        // Members of the same group must be contiguous, as an object cannot
+        // be reopened once it is closed. Keep the original order otherwise.
+        using Entry = std::pair<size_t, const Metadatum*>;
+        std::vector<std::string> groups;
+        std::vector<Entry> entries;
+        entries.reserve(data.count());
+        bool sorted = true;
+        for (auto&& md : data) {
+            size_t rank = groupRank(groups, md.groupName());
+            if (!entries.empty() && rank < entries.back().first) sorted = false;
+            entries.push_back(Entry(rank, &md));
+        }
+        if (!sorted) {
+            std::stable_sort(entries.begin(), entries.end(),
+                             [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; });
+        }
+        for (auto&& e : entries) {
+            add(*e.second);
+        }
+        if (!entries.empty() && !tokens_.empty() && tokens_[0].n == "Xmp") {
+            addNamespaces();
+        }
+    }
+
+    void Emitter::end()
+    {
+        close(0);
+    }
+
+    void Emitter::add(const Metadatum& md)
+    {
+        tokenize(md.key(), tokens_);
+        if (tokens_.size() < 2) return;
+        const size_t leaf = tokens_.size() - 1;
+        if (tokens_[0].n == "Xmp") {
+            namespaces_.insert(tokens_[1].n);
+            for (auto&& t : tokens_) {
+                if (t.ns) namespaces_.insert(t.n);
+            }
+        }
+
+        // Close the levels which are not on the path of this key and open
+        // the missing ones. Level 0 is the root object.
+        size_t common = 0;
+        while (   common < leaf
+               && common + 1 < levels_.size()
+               && levels_[common + 1].name == tokens_[common].n
+               && levels_[common + 1].array == tokens_[common].a) {
+            ++common;
+        }
+        close(common + 1);
+        for (size_t k = common; k < leaf; ++k) {
+            open(tokens_[k]);
+        }
+
+        const Token& t = tokens_[leaf];
+        const TypeId typeId = md.typeId();
+        if (typeId == xmpText) {
+            // Structures and arrays are followed by their members
+            const std::string v = md.toString();
+            const bool isArray = v == "type=\"Seq\"" || v == "type=\"Bag\"" || v == "type=\"Alt\"";
+            if (isArray || v == "type=\"Struct\"") {
+                open({ t.n, isArray, t.i, false });
+                return;
+            }
+        }
+        if (t.n == "MakerNote") return;
+        if (   (typeId == unsignedRational || typeId == signedRational || typeId == langAlt)
+            && md.size() == 0) return;
+        item(t.n);
+        value(md, t.n);
+    }
+
+    void Emitter::addNamespaces()
+    {
+        close(2);
+        item("xmlns");
+        buf_ += '{';
+        levels_.push_back({ "xmlns", false, 0 });
+        for (auto&& prefix : namespaces_) {
+            std::string ns;
+            try {
+                ns = XmpProperties::ns(prefix);
+            }
+            catch (const AnyError&) {
+                // Not a registered namespace prefix
+            }
+            item(prefix);
+            quoted(ns);
+        }
+        close(1);
+        namespaces_.clear();
+    }
+
+    void Emitter::open(const Token& t)
+    {
+        Level& parent = levels_.back();
+        if (parent.array) {
+            // Pad the array up to the element for this index
+            while (t.i > 0 && parent.count + 1 < static_cast<size_t>(t.i)) {
+                separator();
+                buf_ += "{}";
+            }
+        }
+        item(t.n);
+        buf_ += t.a ? '[' : '{';
+        levels_.push_back({ t.n, t.a, 0 });
+    }
+
+    void Emitter::close(size_t depth)
+    {
+        while (levels_.size() > depth) {
+            const Level& level = levels_.back();
+            const bool array = level.array;
+            const bool empty = level.count == 0;
+            levels_.pop_back();
+            if (pretty_ && !empty) {
+                buf_ += '\n';
+                buf_.append(4 * (indent_ + levels_.size()), ' ');
+            }
+            buf_ += array ? ']' : '}';
+        }
+    }
+
+    void Emitter::item(const std::string& name)
+    {
+        separator();
+        if (!levels_.back().array) {
+            quoted(name);
+            buf_ += pretty_ ? ": " : ":";
+        }
+    }
+
+    void Emitter::separator()
+    {
+        Level& level = levels_.back();
+        if (level.count++ > 0) buf_ += ',';
+        if (pretty_) {
+            buf_ += '\n';
+            buf_.append(4 * (indent_ + levels_.size()), ' ');
+        }
+    }
+
+    void Emitter::value(const Metadatum& md, const std::string& name)
+    {
+        const Value& v = md.value();
+        switch (md.typeId()) {
+        case unsignedByte:
+        case unsignedShort:
+        case unsignedLong:
+        case signedByte:
+        case signedShort:
+        case signedLong:
+        case tiffFloat:
+        case tiffDouble:
+            numbers(v.toString(), v.count());
+            break;
+
+        case unsignedRational:
+        case signedRational:
+            numbers(v.toString(), v.count());
+            break;
+
+        case langAlt: {
+            const auto* la = dynamic_cast<const LangAltValue*>(&v);
+            if (la == nullptr) {
+                quoted(v.toString());
+                break;
+            }
+            buf_ += '{';
+            levels_.push_back({ name, false, 0 });
+            item("lang");
+            buf_ += '{';
+            levels_.push_back({ "lang", false, 0 });
+            for (auto&& lang : la->value_) {
+                item(lang.first);
+                quoted(lang.second);
+            }
+            close(levels_.size() - 2);
+            break;
+        }
+
+        case xmpBag:
+        case xmpSeq:
+        case xmpAlt:
+            buf_ += '[';
+            for (long i = 0; i < v.count(); ++i) {
+                if (i > 0) buf_ += pretty_ ? ", " : ",";
+                quoted(v.toString(i));
+            }
+            buf_ += ']';
+            break;
+
+        default:
+            if (name == "UserComment") {
+                // Only up to the first '\0' (if any)
+                std::string s = v.toString();
+                quoted(s.substr(0, s.find('\0')));
+            }
+            else {
+                quoted(v.toString());
+            }
+            break;
+        }
+    }
+
+    void Emitter::quoted(const std::string& s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        buf_ += '"';
+        for (auto&& c : s) {
+            switch (c) {
+            case '"':  buf_ += "\\\""; break;
+            case '\\': buf_ += "\\\\"; break;
+            case '\b': buf_ += "\\b";  break;
+            case '\f': buf_ += "\\f";  break;
+            case '\n': buf_ += "\\n";  break;
+            case '\r': buf_ += "\\r";  break;
+            case '\t': buf_ += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    buf_ += "\\u00";
+                    buf_ += hex[(c >> 4) & 0x0f];
+                    buf_ += hex[c & 0x0f];
+                }
+                else {
+                    buf_ += c;
+                }
+                break;
+            }
+        }
+        buf_ += '"';
+    }
+
+    void Emitter::numbers(const std::string& s, long count)
+    {
+        if (count != 1) buf_ += '[';
+        const char* p = s.c_str();
+        const char* end = p + s.size();
+        bool first = true;
+        while (p < end) {
+            const char* q = std::find(p, end, ' ');
+            if (q > p) {
+                if (!first) buf_ += pretty_ ? ", " : ",";
+                number(p, q);
+                first = false;
+            }
+            p = q + 1;
+        }
+        if (count != 1) buf_ += ']';
+        else if (first) buf_ += "null";
+    }
+
+    void Emitter::number(const char* begin, const char* end)
+    {
+        // nan and inf are not valid JSON numbers
+        if (std::find_if(begin, end, [](char c) { return c == 'n' || c == 'N'; }) != end) {
+            buf_ += "null";
+            return;
+        }
+        const char* slash = std::find(begin, end, '/');
+        if (slash == end) {
+            buf_.append(begin, end);
+            return;
+        }
+        buf_ += '[';
+        buf_.append(begin, slash);
+        buf_ += pretty_ ? ", " : ",";
+        buf_.append(slash + 1, end);
+        buf_ += ']';
+    }
+
+}
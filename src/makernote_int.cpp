@@ -35,9 +35,11 @@
 #include "utils.hpp"
 
 // + standard includes
+#include <array>
 #include <string>
 #include <fstream>
 #include <cstring>
+#include <vector>
 
 #if defined(__MINGW32__) || defined(__MINGW64__)
 #ifndef __MINGW__
@@ -180,10 +182,10 @@ namespace Exiv2 {
 
     bool TiffMnRegistry::operator==(const std::string& key) const
     {
-        std::string make(make_);
         if (!key.empty() && key[0] == '-')
             return false;
-        return make == key.substr(0, make.length());
+        const size_t len = std::strlen(make_);
+        return key.size() >= len && key.compare(0, len, make_) == 0;
     }
 
     bool TiffMnRegistry::operator==(IfdId key) const
@@ -198,8 +200,25 @@ namespace Exiv2 {
                                          uint32_t           size,
                                          ByteOrder          byteOrder)
     {
+        // Index of the registry by the first character of the make, so that
+        // only the entries with that character are compared with the make
+        static const std::array<std::vector<const TiffMnRegistry*>, 256> index = [] {
+            std::array<std::vector<const TiffMnRegistry*>, 256> rows;
+            for (auto&& row : registry_) {
+                rows[static_cast<unsigned char>(row.make_[0])].push_back(&row);
+            }
+            return rows;
+        }();
         TiffComponent* tc = nullptr;
-        const TiffMnRegistry* tmr = find(registry_, make);
+        const TiffMnRegistry* tmr = nullptr;
+        if (!make.empty()) {
+            for (auto&& row : index[static_cast<unsigned char>(make[0])]) {
+                if (*row == make) {
+                    tmr = row;
+                    break;
+                }
+            }
+        }
         if (tmr) {
             assert(tmr->newMnFct_);
             tc = tmr->newMnFct_(tag,
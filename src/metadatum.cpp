@@ -24,6 +24,8 @@
 // + standard includes
 #include <iostream>
 #include <iomanip>
+#include <locale>
+#include <sstream>
 
 
 // *****************************************************************************
@@ -37,7 +39,31 @@ namespace Exiv2 {
 
     std::string Metadatum::print(const ExifData* pMetadata) const
     {
-        std::ostringstream os;
+        // The print functions of the tags write to a stream. Constructing
+        // one for each datum costs more than most print functions, so one
+        // stream per thread is reused, unless a print function prints
+        // another datum.
+        thread_local std::ostringstream os;
+        thread_local const std::ostringstream clean;
+        thread_local bool inUse = false;
+        if (inUse) {
+            std::ostringstream local;
+            write(local, pMetadata);
+            return local.str();
+        }
+        struct Guard {
+            Guard() { inUse = true; }
+            ~Guard() { inUse = false; }
+        } guard;
+
+        // Reset the stream to the state of a new one. Print functions may
+        // change the format flags, the fill character, the exception mask,
+        // iword() and pword(), copyfmt() resets all of them.
+        os.str(std::string());
+        os.copyfmt(clean);
+        os.clear();
+        const std::locale loc;
+        if (os.getloc() != loc) os.imbue(loc);
         write(os, pMetadata);
         return os.str();
     }
@@ -1959,7 +1959,7 @@ namespace Exiv2 {
             return os << buffer;
         }
 #endif
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 #endif
 
@@ -2028,7 +2028,7 @@ namespace Exiv2 {
 
     static std::ostream& resolvedLens(std::ostream& os,long lensID,long index)
     {
-        const TagDetails* td = find(minoltaSonyLensID, lensID);
+        const TagDetails* td = EXV_FIND_INDEXED(minoltaSonyLensID, lensID);
         std::vector<std::string> tokens = split(td[0].label_,"|");
         return os << exvGettext(trim(tokens.at(index-1)).c_str());
     }
@@ -2052,7 +2052,7 @@ namespace Exiv2 {
             }
         } catch (...) {
         }
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     static std::ostream& resolveLens0x29(std::ostream& os, const Value& value,
@@ -2075,7 +2075,7 @@ namespace Exiv2 {
         } catch (...) {
 
         }
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     static std::ostream& resolveLens0x34(std::ostream& os, const Value& value,
@@ -2102,7 +2102,7 @@ namespace Exiv2 {
             }
         } catch (...) {
         }
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     static std::ostream& resolveLens0x80(std::ostream& os, const Value& value,
@@ -2125,7 +2125,7 @@ namespace Exiv2 {
                 return resolvedLens(os,lensID,index);
             }
         } catch (...) {}
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     static std::ostream& resolveLens0xff(std::ostream& os, const Value& value,
@@ -2149,7 +2149,7 @@ namespace Exiv2 {
             }
         } catch (...) {
         }
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     static std::ostream& resolveLens0xffff(std::ostream& os, const Value& value,
@@ -2199,7 +2199,7 @@ namespace Exiv2 {
             }
         } catch (...) {}
 
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     struct LensIdFct {
@@ -2228,11 +2228,13 @@ namespace Exiv2 {
         const std::string undefined("undefined") ;
         const std::string minolta  ("minolta");
         const std::string sony     ("sony");
-        if ( Internal::readExiv2Config(minolta,value.toString(),undefined) != undefined ) {
-            return os << Internal::readExiv2Config(minolta,value.toString(),undefined);
+        std::string lens = Internal::readExiv2Config(minolta,value.toString(),undefined);
+        if ( lens != undefined ) {
+            return os << lens;
         }
-        if ( Internal::readExiv2Config(sony,value.toString(),undefined) != undefined ) {
-            return os << Internal::readExiv2Config(sony,value.toString(),undefined);
+        lens = Internal::readExiv2Config(sony,value.toString(),undefined);
+        if ( lens != undefined ) {
+            return os << lens;
         }
 
         // #1145 - respect lenses with shared LensID
@@ -2243,7 +2245,7 @@ namespace Exiv2 {
                 return lif->fct_(os, value, metadata);
         }
 
-        return EXV_PRINT_TAG(minoltaSonyLensID)(os, value, metadata);
+        return EXV_PRINT_TAG_INDEXED(minoltaSonyLensID)(os, value, metadata);
     }
 
     // ----------------------------------------------------------------------------------------------------
@@ -37,6 +37,7 @@
 #include <iomanip>
 #include <cassert>
 #include <cstring>
+#include <vector>
 #include <math.h> //for log, pow, abs
 
 // *****************************************************************************
@@ -1788,8 +1789,9 @@ namespace Exiv2 {
         bool result = false;
         const std::string undefined("undefined") ;
         const std::string section  ("nikon");
-        if ( Internal::readExiv2Config(section,value.toString(),undefined) != undefined ) {
-            os << Internal::readExiv2Config(section,value.toString(),undefined);
+        const std::string lens = Internal::readExiv2Config(section,value.toString(),undefined);
+        if ( lens != undefined ) {
+            os << lens;
             result = true;
         }
         return result;
@@ -2644,29 +2646,39 @@ fmountlens[] = {
         }
         raw[7] = static_cast<byte>(md->toLong());
 
-        for (int i = 0; fmountlens[i].lensname != nullptr; ++i) {
-            if (   raw[0] == fmountlens[i].lid ) {
-                // #1034
-                const std::string  undefined("undefined") ;
-                const std::string  section  ("nikon");
-                std::ostringstream lensIDStream;
-                lensIDStream << static_cast<int>(raw[7]);
-                if ( Internal::readExiv2Config(section,lensIDStream.str(),undefined) != undefined ) {
-                    return os << Internal::readExiv2Config(section,lensIDStream.str(),undefined);
-                }
+        // Index of the lenses in fmountlens by their LensIDNumber, in the order of the list
+        static const std::vector<std::vector<const FMntLens*>> lensesById = [] {
+            std::vector<std::vector<const FMntLens*>> index(256);
+            for (const FMntLens* pf = fmountlens; pf->lensname != nullptr; ++pf) {
+                index[pf->lid].push_back(pf);
+            }
+            return index;
+        }();
+
+        const std::vector<const FMntLens*>& lenses = lensesById[raw[0]];
+        if (!lenses.empty()) {
+            // #1034
+            const std::string  undefined("undefined") ;
+            const std::string  section  ("nikon");
+            std::ostringstream lensIDStream;
+            lensIDStream << static_cast<int>(raw[7]);
+            const std::string lens = Internal::readExiv2Config(section,lensIDStream.str(),undefined);
+            if ( lens != undefined ) {
+                return os << lens;
             }
+        }
 
-            if (   raw[0] == fmountlens[i].lid
-                // stps varies with focal length for some Sigma zoom lenses.
-                &&(raw[1] == fmountlens[i].stps || strcmp(fmountlens[i].manuf, "Sigma") == 0)
-                && raw[2] == fmountlens[i].focs
-                && raw[3] == fmountlens[i].focl
-                && raw[4] == fmountlens[i].aps
-                && raw[5] == fmountlens[i].apl
-                && raw[6] == fmountlens[i].lfw
-                && raw[7] == fmountlens[i].ltype) {
+        for (auto&& pf : lenses) {
+            if (   // stps varies with focal length for some Sigma zoom lenses.
+                   (raw[1] == pf->stps || strcmp(pf->manuf, "Sigma") == 0)
+                && raw[2] == pf->focs
+                && raw[3] == pf->focl
+                && raw[4] == pf->aps
+                && raw[5] == pf->apl
+                && raw[6] == pf->lfw
+                && raw[7] == pf->ltype) {
                 // Lens found in database
-                return os << fmountlens[i].manuf << " " << fmountlens[i].lensname;
+                return os << pf->manuf << " " << pf->lensname;
             }
         }
         // Lens not found in database
@@ -108,8 +108,11 @@ namespace Exiv2 {
             throw Error(kerNotAnImage, "ORF");
         }
         clearMetadata();
-        ByteOrder bo =
-            OrfParser::decode(exifData_, iptcData_, xmpData_, io_->mmap(), static_cast<uint32_t>(io_->size()));
+        // Only the parts of the file which are parsed are read from remote IO
+        OrfHeader orfHeader;
+        ByteOrder bo = TiffParserWorker::decode(exifData_, iptcData_, xmpData_, io_->mmapSparse(),
+                                                static_cast<uint32_t>(io_->size()), Tag::root,
+                                                TiffMapping::findDecoder, &orfHeader, io_.get());
         setByteOrder(bo);
     } // OrfImage::readMetadata
 
@@ -1247,7 +1247,7 @@ namespace Exiv2 {
 
             if ( index > 0 )  {
                 const unsigned long lensID    = 0x32c;
-                const TagDetails* td = find(pentaxLensType, lensID);
+                const TagDetails* td = EXV_FIND_INDEXED(pentaxLensType, lensID);
                 os << exvGettext(td[index].label_);
                 return os;
             }
@@ -1303,7 +1303,7 @@ namespace Exiv2 {
 
             if ( index > 0 )  {
                 const unsigned long lensID = 0x3ff;
-                const TagDetails* td = find(pentaxLensType, lensID);
+                const TagDetails* td = EXV_FIND_INDEXED(pentaxLensType, lensID);
                 os << exvGettext(td[index].label_);
                 return os;
             }
@@ -1328,7 +1328,7 @@ namespace Exiv2 {
 
             if ( index > 0 )  {
                 const unsigned long lensID = 0x8ff;
-                const TagDetails* td = find(pentaxLensType, lensID);
+                const TagDetails* td = EXV_FIND_INDEXED(pentaxLensType, lensID);
                 os << exvGettext(td[index].label_);
                 return os;
             }
@@ -1361,7 +1361,7 @@ namespace Exiv2 {
 
             if ( index > 0 )  {
                 const unsigned long lensID = 0x319;
-                const TagDetails* td = find(pentaxLensType, lensID);
+                const TagDetails* td = EXV_FIND_INDEXED(pentaxLensType, lensID);
                 os << exvGettext(td[index].label_);
                 return os;
             }
@@ -1408,8 +1408,9 @@ namespace Exiv2 {
         // #1034
         const std::string  undefined("undefined") ;
         const std::string  section  ("pentax");
-        if ( Internal::readExiv2Config(section,value.toString(),undefined) != undefined ) {
-            return os << Internal::readExiv2Config(section,value.toString(),undefined);
+        const std::string  lens = Internal::readExiv2Config(section,value.toString(),undefined);
+        if ( lens != undefined ) {
+            return os << lens;
         }
 
         unsigned long index = value.toLong(0)*256+value.toLong(1);
@@ -92,7 +92,7 @@ namespace Exiv2 {
             }
             l += (value.toLong(c) << ((count - c - 1) * 8));
         }
-        const TagDetails* td = find(array, l);
+        const TagDetails* td = findIndexed<N, array>(l);
         if (td) {
             os << exvGettext(td->label_);
         }
@@ -363,12 +363,7 @@ namespace Exiv2 {
 #endif
                     xmpPacket = xmpPacket.substr(idx);
                 }
-                if (XmpParser::decode(pImage->xmpData(), xmpPacket))
-                {
-#ifndef SUPPRESS_WARNINGS
-                    EXV_WARNING << "Failed to decode XMP metadata.\n";
-#endif
-                }
+                pImage->xmpData().setPacketDeferred(xmpPacket);
             }
         }
 
@@ -391,12 +386,7 @@ namespace Exiv2 {
 #endif
                     xmpPacket = xmpPacket.substr(idx);
                 }
-                if (XmpParser::decode(pImage->xmpData(), xmpPacket))
-                {
-#ifndef SUPPRESS_WARNINGS
-                    EXV_WARNING << "Failed to decode XMP metadata.\n";
-#endif
-                }
+                pImage->xmpData().setPacketDeferred(xmpPacket);
             }
         }
 
@@ -443,41 +433,49 @@ namespace Exiv2 {
 
     } // PngChunk::makeMetadataChunk
 
-    void PngChunk::zlibUncompress(const byte*  compressedText,
-                                  unsigned int compressedTextSize,
-                                  DataBuf&     arr)
+    bool PngChunk::zlibInflate(const byte* compressed,
+                               long        compressedSize,
+                               DataBuf&    arr,
+                               long        maxSize)
     {
-        uLongf uncompressedLen = compressedTextSize * 2; // just a starting point
-        int zlibResult;
-        int dos = 0;
-
-        do {
-            arr.alloc(uncompressedLen);
-            zlibResult = uncompress(arr.data(),
-                                    &uncompressedLen,
-                                    compressedText,
-                                    compressedTextSize);
-            if (zlibResult == Z_OK) {
-                assert((uLongf)arr.size() >= uncompressedLen);
-                arr.resize(uncompressedLen);
-            }
-            else if (zlibResult == Z_BUF_ERROR) {
-                // the uncompressedArray needs to be larger
-                uncompressedLen *= 2;
-                // DoS protection. can't be bigger than 64k
-                if (uncompressedLen > 131072) {
-                    if (++dos > 1) break;
-                    uncompressedLen = 131072;
-                }
-            }
-            else {
-                // something bad happened
-                throw Error(kerFailedToReadImageData);
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (inflateInit(&stream) != Z_OK) return false;
+        stream.next_in = const_cast<Bytef*>(compressed);
+        stream.avail_in = static_cast<uInt>(compressedSize);
+
+        // Start with twice the compressed size and double the buffer
+        // whenever it is full, the data is only inflated once.
+        arr.alloc(std::min(std::max(2 * compressedSize, 1024L), maxSize));
+        long used = 0;
+        int zlibResult = Z_OK;
+        while (zlibResult == Z_OK) {
+            if (used == arr.size()) {
+                // DoS protection
+                if (arr.size() >= maxSize) break;
+                arr.resize(std::min(2 * arr.size(), maxSize));
             }
+            const auto avail = static_cast<uInt>(arr.size() - used);
+            stream.next_out = arr.data(used);
+            stream.avail_out = avail;
+            zlibResult = inflate(&stream, Z_NO_FLUSH);
+            used += static_cast<long>(avail - stream.avail_out);
         }
-        while (zlibResult == Z_BUF_ERROR);
+        inflateEnd(&stream);
+        if (zlibResult != Z_STREAM_END) {
+            arr.reset();
+            return false;
+        }
+        arr.resize(used);
+        return true;
+    } // PngChunk::zlibInflate
 
-        if (zlibResult != Z_OK) {
+    void PngChunk::zlibUncompress(const byte*  compressedText,
+                                  unsigned int compressedTextSize,
+                                  DataBuf&     arr)
+    {
+        // DoS protection. can't be bigger than 128k
+        if (!zlibInflate(compressedText, static_cast<long>(compressedTextSize), arr, 131072)) {
             throw Error(kerFailedToReadImageData);
         }
     } // PngChunk::zlibUncompress
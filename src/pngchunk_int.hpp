@@ -113,6 +113,23 @@ namespace Exiv2 {
         static std::string makeMetadataChunk(const std::string& metadata,
                                                    MetadataId   type);
 
+        /*!
+          @brief Inflate zlib compressed data in a single pass. The output
+                 buffer \em arr grows as needed, up to \em maxSize bytes.
+
+          @param compressed     Compressed data.
+          @param compressedSize Size of the compressed data.
+          @param arr            Buffer for the uncompressed data.
+          @param maxSize        Maximum size of the uncompressed data.
+
+          @return true if the complete stream was inflated, else false and
+                  \em arr is empty.
+        */
+        static bool zlibInflate(const byte* compressed,
+                                long        compressedSize,
+                                DataBuf&    arr,
+                                long        maxSize);
+
     private:
         /*!
           @brief Parse PNG Text chunk to determine type and extract content.
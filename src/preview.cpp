@@ -31,6 +31,7 @@
 #include "safe_op.hpp"
 
 #include "image.hpp"
+#include "image_int.hpp"
 #include "cr2image.hpp"
 #include "jpgimage.hpp"
 #include "tiffimage.hpp"
@@ -103,6 +104,13 @@ namespace {
         //! Get a buffer that contains the preview image
         virtual DataBuf getData() const = 0;
 
+        /*!
+          @brief Get the range of the source image which holds the preview image
+                 unchanged. Return false if there is no such range, i.e., if
+                 the preview is decoded or assembled from several parts.
+         */
+        virtual bool getRange(long& /*offset*/, long& /*size*/) const { return false; }
+
         //! Read preview image dimensions when they are not available directly
         virtual bool readDimensions() { return true; }
 
@@ -157,6 +165,9 @@ namespace {
         //! Get a buffer that contains the preview image
         DataBuf getData() const override;
 
+        //! Get the range of the source image which holds the preview image
+        bool getRange(long& offset, long& size) const override;
+
         //! Read preview image dimensions
         bool readDimensions() override;
 
@@ -181,6 +192,9 @@ namespace {
         //! Get a buffer that contains the preview image
         DataBuf getData() const override;
 
+        //! Get the range of the source image which holds the preview image
+        bool getRange(long& offset, long& size) const override;
+
         //! Read preview image dimensions
         bool readDimensions() override;
 
@@ -495,6 +509,17 @@ namespace {
         throw Error(kerErrorMessage, "Invalid native preview filter: " + nativePreview_.filter_);
     }
 
+    bool LoaderNative::getRange(long& offset, long& size) const
+    {
+        if (!valid() || !nativePreview_.filter_.empty()) return false;
+        if (static_cast<long>(image_.io().size()) < nativePreview_.position_ + static_cast<long>(nativePreview_.size_)) {
+            return false;
+        }
+        offset = nativePreview_.position_;
+        size = static_cast<long>(nativePreview_.size_);
+        return true;
+    }
+
     bool LoaderNative::readDimensions()
     {
         if (!valid()) return false;
@@ -578,6 +603,14 @@ namespace {
         return DataBuf(base + offset_, size_);
     }
 
+    bool LoaderExifJpeg::getRange(long& offset, long& size) const
+    {
+        if (!valid()) return false;
+        offset = static_cast<long>(offset_);
+        size = static_cast<long>(size_);
+        return true;
+    }
+
     bool LoaderExifJpeg::readDimensions()
     {
         if (!valid()) return false;
@@ -1056,18 +1089,22 @@ namespace Exiv2 {
     long PreviewImage::writeFile(const std::string& path) const
     {
         std::string name = path + extension();
-        // Todo: Creating a DataBuf here unnecessarily copies the memory
-        DataBuf buf(pData(), size());
-        return Exiv2::writeFile(buf, name);
+        FileIo file(name);
+        if (file.open("wb") != 0) {
+            throw Error(kerFileOpenFailed, name, "wb", strError());
+        }
+        return file.write(pData(), static_cast<long>(size()));
     }
 
 #ifdef EXV_UNICODE_PATH
     long PreviewImage::writeFile(const std::wstring& wpath) const
     {
         std::wstring name = wpath + wextension();
-        // Todo: Creating a DataBuf here unnecessarily copies the memory
-        DataBuf buf(pData(), size());
-        return Exiv2::writeFile(buf, name);
+        FileIo file(name);
+        if (file.open("wb") != 0) {
+            throw WError(kerFileOpenFailed, name, "wb", strError().c_str());
+        }
+        return file.write(pData(), static_cast<long>(size()));
     }
 
 #endif
@@ -1131,8 +1168,14 @@ namespace Exiv2 {
             Loader::UniquePtr loader = Loader::create(id, image_);
             if (loader.get() && loader->readDimensions()) {
                 PreviewProperties props = loader->getProperties();
-                DataBuf buf             = loader->getData(); // #16 getPreviewImage()
-                props.size_             = buf.size();        //     update the size
+                long offset = 0;
+                long size = 0;
+                if (loader->getRange(offset, size)) {
+                    props.size_ = static_cast<uint32_t>(size);
+                } else {
+                    DataBuf buf = loader->getData(); // #16 getPreviewImage()
+                    props.size_ = buf.size();        //     update the size
+                }
                 list.push_back(props) ;
             }
         }
@@ -1150,4 +1193,28 @@ namespace Exiv2 {
 
         return PreviewImage(properties, buf);
     }
+
+    bool PreviewManager::getPreviewRange(const PreviewProperties& properties, long& offset, long& size) const
+    {
+        Loader::UniquePtr loader = Loader::create(properties.id_, image_);
+        return loader.get() && loader->getRange(offset, size);
+    }
+
+    long PreviewManager::copyPreview(const PreviewProperties& properties, BasicIo& io) const
+    {
+        long offset = 0;
+        long size = 0;
+        if (getPreviewRange(properties, offset, size)) {
+            BasicIo& src = image_.io();
+            if (src.open() != 0) {
+                throw Error(kerDataSourceOpenFailed, src.path(), strError());
+            }
+            IoCloser closer(src);
+            src.seek(offset, BasicIo::beg);
+            Internal::copyIo(src, io, size);
+            return size;
+        }
+        const PreviewImage preview = getPreviewImage(properties);
+        return io.write(preview.pData(), static_cast<long>(preview.size()));
+    }
 }                                       // namespace Exiv2
@@ -24,6 +24,7 @@
 #include "psdimage.hpp"
 #include "jpgimage.hpp"
 #include "image.hpp"
+#include "image_int.hpp"
 #include "basicio.hpp"
 #include "error.hpp"
 #include "futils.hpp"
@@ -280,11 +281,7 @@ namespace Exiv2 {
                 io_->read(xmpPacket.data(), xmpPacket.size());
                 if (io_->error() || io_->eof()) throw Error(kerFailedToReadImageData);
                 xmpPacket_.assign(xmpPacket.c_str(), xmpPacket.size());
-                if (!xmpPacket_.empty() && XmpParser::decode(xmpData_, xmpPacket_)) {
-#ifndef SUPPRESS_WARNINGS
-                    EXV_WARNING << "Failed to decode XMP metadata.\n";
-#endif
-                }
+                xmpData_.setPacketDeferred(xmpPacket_);
                 break;
             }
 
@@ -350,7 +347,7 @@ namespace Exiv2 {
             throw Error(kerDataSourceOpenFailed, io_->path(), strError());
         }
         IoCloser closer(*io_);
-        BasicIo::UniquePtr tempIo(new MemIo);
+        BasicIo::UniquePtr tempIo = Internal::createTempIo(*io_);
         assert (tempIo.get() != 0);
 
         doWriteMetadata(*tempIo); // may throw
@@ -546,11 +543,8 @@ namespace Exiv2 {
         // it avoids allocating memory for parts of the file that contain image-date.
         io_->populateFakeData();
 
-        // Copy remaining data
-        long readSize = 0;
-        while ((readSize=io_->read(lbuf.data(), lbuf.size()))) {
-            if (outIo.write(lbuf.c_data(), readSize) != readSize) throw Error(kerImageWriteFailed);
-        }
+        // Copy remaining data, the layer and mask information and the image data
+        Internal::copyIo(*io_, outIo, io_->size() - io_->tell());
         if (outIo.error()) throw Error(kerImageWriteFailed);
 
         // Update length of resources
@@ -646,12 +640,13 @@ namespace Exiv2 {
         std::cerr << "writeXmpFromPacket(): " << writeXmpFromPacket() << "\n";
 #endif
 //        writeXmpFromPacket(true);
-        if (!writeXmpFromPacket()) {
-            if (XmpParser::encode(xmpPacket, xmpData) > 1) {
+        if (writeXmpFromPacket()) {
+            xmpPacket = xmpPacket_;
+        }
+        else if (XmpParser::encode(xmpPacket, xmpData) > 1) {
 #ifndef SUPPRESS_WARNINGS
-                EXV_ERROR << "Failed to encode XMP metadata.\n";
+            EXV_ERROR << "Failed to encode XMP metadata.\n";
 #endif
-            }
         }
 
         if (!xmpPacket.empty()) {
@@ -119,8 +119,11 @@ namespace Exiv2 {
             throw Error(kerNotAnImage, "RW2");
         }
         clearMetadata();
-        ByteOrder bo =
-            Rw2Parser::decode(exifData_, iptcData_, xmpData_, io_->mmap(), static_cast<uint32_t>(io_->size()));
+        // Only the parts of the file which are parsed are read from remote IO
+        Rw2Header rw2Header;
+        ByteOrder bo = TiffParserWorker::decode(exifData_, iptcData_, xmpData_, io_->mmapSparse(),
+                                                static_cast<uint32_t>(io_->size()), Tag::pana,
+                                                TiffMapping::findDecoder, &rw2Header, io_.get());
         setByteOrder(bo);
 
         // A lot more metadata is hidden in the embedded preview image
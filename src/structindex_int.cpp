@@ -0,0 +1,158 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+// included header files
+#include "config.h"
+#include "structindex_int.hpp"
+#include "version.hpp"
+
+// + standard includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef EXV_HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#if defined(EXV_HAVE_UNISTD_H) && !defined(_WIN32)
+# define EXV_STRUCTINDEX 1
+#endif
+
+// *****************************************************************************
+namespace {
+    //! Layout of the header at the start of an index file, the ranges follow
+    struct IndexHeader {
+        char     magic[8];                      //!< Identifies the file and its version
+        uint32_t version;                       //!< Library version which saved the index
+        uint32_t count;                         //!< Number of ranges
+        uint64_t identity[5];                   //!< Identity of the indexed file
+    };
+
+    //! Layout of a range in an index file
+    struct IndexRange {
+        uint32_t offset;                        //!< Offset of the range
+        uint32_t size;                          //!< Size of the range
+    };
+
+    const char     indexMagic[8] = { 'e', 'x', 'v', '2', 'i', 'd', 'x', '1' };
+    const uint32_t maxRanges = 65536;           //!< Upper limit of the ranges of an index
+    const long     rangeGap = 4096;             //!< Ranges closer than this are merged when saved
+}
+
+// *****************************************************************************
+// class member definitions
+namespace Exiv2 {
+    namespace Internal {
+
+    StructureIndex::StructureIndex(const std::string& dir, const std::string& path)
+        : identity_(), found_(false)
+    {
+#ifdef EXV_STRUCTINDEX
+        struct stat buf;
+        if (dir.empty() || path.empty() || ::stat(path.c_str(), &buf) != 0 || !S_ISREG(buf.st_mode)) return;
+        identity_[0] = static_cast<uint64_t>(buf.st_dev);
+        identity_[1] = static_cast<uint64_t>(buf.st_ino);
+        identity_[2] = static_cast<uint64_t>(buf.st_size);
+        identity_[3] = static_cast<uint64_t>(buf.st_mtime);
+        identity_[4] = static_cast<uint64_t>(buf.st_ctime);
+#if defined(__linux__)
+        identity_[3] = identity_[3] * 1000000000 + static_cast<uint64_t>(buf.st_mtim.tv_nsec);
+        identity_[4] = identity_[4] * 1000000000 + static_cast<uint64_t>(buf.st_ctim.tv_nsec);
+#endif
+        char name[48];
+        std::snprintf(name, sizeof(name), "exiv2-%llx-%llx.idx",
+                      static_cast<unsigned long long>(identity_[0]), static_cast<unsigned long long>(identity_[1]));
+        path_ = dir + EXV_SEPARATOR_STR + name;
+
+        FILE* fp = std::fopen(path_.c_str(), "rb");
+        if (!fp) return;
+        IndexHeader header;
+        if (   std::fread(&header, sizeof(header), 1, fp) == 1
+            && std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0
+            && header.version == static_cast<uint32_t>(versionNumber())
+            && std::memcmp(header.identity, identity_, sizeof(identity_)) == 0
+            && header.count <= maxRanges) {
+            std::vector<IndexRange> ranges(header.count);
+            if (header.count == 0 || std::fread(ranges.data(), sizeof(IndexRange), header.count, fp) == header.count) {
+                for (auto&& range : ranges) {
+                    ranges_.emplace_back(range.offset, range.size);
+                }
+                found_ = true;
+            }
+        }
+        std::fclose(fp);
+#else
+        (void)dir;
+        (void)path;
+#endif
+    }
+
+    void StructureIndex::save()
+    {
+#ifdef EXV_STRUCTINDEX
+        if (found_ || path_.empty() || ranges_.empty()) return;
+        merge(ranges_, rangeGap);
+        if (ranges_.size() > maxRanges) return;
+
+        IndexHeader header;
+        std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+        header.version = static_cast<uint32_t>(versionNumber());
+        header.count = static_cast<uint32_t>(ranges_.size());
+        std::memcpy(header.identity, identity_, sizeof(identity_));
+        std::vector<IndexRange> ranges;
+        for (auto&& range : ranges_) {
+            IndexRange r;
+            r.offset = static_cast<uint32_t>(range.first);
+            r.size = static_cast<uint32_t>(range.second);
+            ranges.push_back(r);
+        }
+
+        // readers in other processes see the old or the new index, not a part
+        const std::string temp = path_ + "." + std::to_string(::getpid()) + "_"
+                               + std::to_string(reinterpret_cast<uintptr_t>(this));
+        FILE* fp = std::fopen(temp.c_str(), "wb");
+        if (!fp) return;
+        bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1
+               && std::fwrite(ranges.data(), sizeof(IndexRange), ranges.size(), fp) == ranges.size();
+        ok = std::fclose(fp) == 0 && ok;
+        if (!ok || std::rename(temp.c_str(), path_.c_str()) != 0) {
+            std::remove(temp.c_str());
+        }
+#endif
+    }
+
+    void StructureIndex::merge(FileRanges& ranges, long gap)
+    {
+        if (ranges.empty()) return;
+        std::sort(ranges.begin(), ranges.end());
+        size_t last = 0;
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            const long end = ranges[last].first + ranges[last].second;
+            if (ranges[i].first <= end + gap) {
+                ranges[last].second = std::max(end, ranges[i].first + ranges[i].second) - ranges[last].first;
+            } else {
+                ranges[++last] = ranges[i];
+            }
+        }
+        ranges.resize(last + 1);
+    }
+
+}}                                      // namespace Internal, Exiv2
@@ -0,0 +1,114 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+/*!
+  @file    structindex_int.hpp
+  @brief   Persistent index of the parts of a file which hold its metadata
+ */
+#ifndef STRUCTINDEX_INT_HPP_
+#define STRUCTINDEX_INT_HPP_
+
+// *****************************************************************************
+// included header files
+#include "types.hpp"
+
+// + standard includes
+#include <string>
+#include <utility>
+#include <vector>
+
+// *****************************************************************************
+// namespace extensions
+namespace Exiv2 {
+    namespace Internal {
+
+// *****************************************************************************
+// class definitions
+
+    //! Ranges of a file, pairs of offset and size
+    using FileRanges = std::vector<std::pair<long, long> >;
+
+    /*!
+      @brief Index of the ranges of a local file which a parser reads, kept
+             in a cache directory for the next time the file is parsed.
+
+      The index of a file is identified by its device and inode and is only
+      valid while the size, modification and change times of the file and
+      the library version are the same as when it was saved. A parser which
+      finds a valid index announces the ranges with BasicIo::prefetch()
+      before it parses the file, so that they are read at once instead of
+      one after the other as the structures are discovered. Otherwise it
+      records the ranges it reads with recorder() and saves them.
+
+      The index is only a hint, the data is always read from the file.
+      It is available on platforms with stat(2) inode numbers. Elsewhere,
+      and for files which are not local, found() is always false and
+      save() does nothing.
+     */
+    class StructureIndex {
+    public:
+        //! @name Creators
+        //@{
+        /*!
+          @brief Load the index of the file at \em path from directory
+                 \em dir. No index is used if \em dir is empty.
+         */
+        StructureIndex(const std::string& dir, const std::string& path);
+        //@}
+
+        //! @name Manipulators
+        //@{
+        /*!
+          @brief Return the list to which the ranges which are read from the
+                 file are added, 0 if the index was found or is not used.
+         */
+        FileRanges* recorder() { return found_ || path_.empty() ? nullptr : &ranges_; }
+        /*!
+          @brief Save the ranges which were added, if the index was not
+                 found. Failures are ignored.
+         */
+        void save();
+        //@}
+
+        //! @name Accessors
+        //@{
+        //! Return true if a valid index of the file was loaded
+        bool found() const { return found_; }
+        //! Return the ranges of the index which was found or the ranges which were added
+        const FileRanges& ranges() const { return ranges_; }
+        //@}
+
+        /*!
+          @brief Sort \em ranges and merge those which overlap or are less
+                 than \em gap bytes apart.
+         */
+        static void merge(FileRanges& ranges, long gap);
+
+    private:
+        // DATA
+        std::string path_;                      //!< Path of the index file, empty if there is none
+        uint64_t    identity_[5];               //!< Device, inode, size, modification and change time
+        FileRanges  ranges_;                    //!< Ranges of the file
+        bool        found_;                     //!< True if the index was loaded
+
+    }; // class StructureIndex
+
+}}                                      // namespace Internal, Exiv2
+
+#endif                                  // #ifndef STRUCTINDEX_INT_HPP_
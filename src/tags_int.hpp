@@ -30,6 +30,8 @@
 #include <string>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 // *****************************************************************************
 // namespace extensions
@@ -281,6 +283,69 @@ namespace Exiv2 {
 //! Shortcut for the printTag template which requires typing the array name only once.
 #define EXV_PRINT_TAG(array) printTag<EXV_COUNTOF(array), array>
 
+    //! List of pointers to the entries of a lookup table which have the same tag value
+    using TagDetailsList = std::vector<const TagDetails*>;
+
+    /*!
+      @brief Return all entries of the lookup table \em array with the tag value
+             \em val, in the order of the table.
+
+      Intended for large tables, like lens lists, which are searched often and
+      may have several entries for the same value. The index is built on first
+      use, each lookup takes constant time.
+     */
+    template <int N, const TagDetails (&array)[N]>
+    const TagDetailsList& findAll(int64_t val)
+    {
+        static const std::unordered_map<int64_t, TagDetailsList> index = [] {
+            std::unordered_map<int64_t, TagDetailsList> idx;
+            for (auto&& td : array) {
+                idx[td.val_].push_back(&td);
+            }
+            return idx;
+        }();
+        static const TagDetailsList none;
+        auto pos = index.find(val);
+        return pos == index.end() ? none : pos->second;
+    }
+
+    /*!
+      @brief Return the first entry of the lookup table \em array with the tag
+             value \em val or 0 if there is none. Same as find(), using the index
+             of findAll().
+     */
+    template <int N, const TagDetails (&array)[N]>
+    const TagDetails* findIndexed(int64_t val)
+    {
+        const TagDetailsList& tds = findAll<N, array>(val);
+        return tds.empty() ? nullptr : tds.front();
+    }
+
+    /*!
+      @brief Generic pretty-print function to translate a long value to a description
+             by looking up a large reference table. Same as printTag(), using the
+             index of findAll().
+     */
+    template <int N, const TagDetails (&array)[N]>
+    std::ostream& printTagIndexed(std::ostream& os, const Value& value, const ExifData*)
+    {
+        const TagDetails* td = findIndexed<N, array>(value.toLong());
+        if (td) {
+            os << exvGettext(td->label_);
+        }
+        else {
+            os << "(" << value << ")";
+        }
+        return os;
+    }
+
+//! Shortcut for the findAll template which requires typing the array name only once.
+#define EXV_FIND_ALL(array, val) findAll<EXV_COUNTOF(array), array>(val)
+//! Shortcut for the findIndexed template which requires typing the array name only once.
+#define EXV_FIND_INDEXED(array, val) findIndexed<EXV_COUNTOF(array), array>(val)
+//! Shortcut for the printTagIndexed template which requires typing the array name only once.
+#define EXV_PRINT_TAG_INDEXED(array) printTagIndexed<EXV_COUNTOF(array), array>
+
     /*!
       @brief Generic print function to translate a long value to a description
              by looking up bitmasks in a reference table.
@@ -98,6 +98,7 @@ namespace Exiv2 {
           size_(0),
           pData_(nullptr),
           isMalloced_(false),
+          isVerbatim_(false),
           idx_(0),
           pValue_(nullptr)
     {
@@ -219,6 +220,7 @@ namespace Exiv2 {
           size_(rhs.size_),
           pData_(rhs.pData_),
           isMalloced_(rhs.isMalloced_),
+          isVerbatim_(rhs.isVerbatim_),
           idx_(rhs.idx_),
           pValue_(rhs.pValue_ ? rhs.pValue_->clone().release() : nullptr)
     {
@@ -334,16 +336,29 @@ namespace Exiv2 {
         }
         pData_ = pData;
         size_  = size;
+        isVerbatim_ = false;
         if (pData_ == nullptr)
             size_ = 0;
     }
 
+    void TiffEntryBase::setVerbatimData(const TiffEntryBase& source)
+    {
+        setData(source.pData_, source.size_);
+        isMalloced_ = false;
+        isVerbatim_ = pData_ != nullptr;
+        tiffType_ = source.tiffType_;
+        count_ = source.count_;
+        delete pValue_;
+        pValue_ = nullptr;
+    }
+
     void TiffEntryBase::updateValue(Value::UniquePtr value, ByteOrder byteOrder)
     {
         if (value.get() == nullptr)
             return;
         uint32_t newSize = value->size();
-        if (newSize > size_) {
+        // Never overwrite verbatim data, it belongs to the source tree
+        if (newSize > size_ || isVerbatim_) {
             setData(DataBuf(newSize));
         }
         if (pData_ != nullptr) {
@@ -1228,6 +1243,10 @@ namespace Exiv2 {
                                     uint32_t  /*dataIdx*/,
                                     uint32_t& /*imageIdx*/)
     {
+        if (isVerbatim_) {
+            ioWrapper.write(pData_, size_);
+            return size_;
+        }
         if (!pValue_) return 0;
 
         DataBuf buf(pValue_->size());
@@ -440,6 +440,13 @@ namespace Exiv2 {
         void setData(byte* pData, int32_t size);
         //! Set the entry's data buffer, taking ownership of the data buffer passed in.
         void setData(DataBuf buf);
+        /*!
+          @brief Use the type, count and data of the same entry \em source
+                 of a parsed tree (not taking ownership of the data). The data
+                 is written as is, without a value to encode, until the value
+                 is updated.
+         */
+        void setVerbatimData(const TiffEntryBase& source);
          /*!
           @brief Update the value. Takes ownership of the pointer passed in.
 
@@ -547,6 +554,7 @@ namespace Exiv2 {
         uint32_t size_;
         byte*    pData_;      //!< Pointer to the data area
         bool     isMalloced_; //!< True if this entry owns the value data
+        bool     isVerbatim_; //!< True if the value data is written as is from the source tree
         int      idx_;        //!< Unique id of the entry in the image
         Value*   pValue_;     //!< Converted data value
 
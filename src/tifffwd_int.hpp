@@ -26,8 +26,11 @@
 #include "tags_int.hpp"
 
 // + standard includes
+#include <map>
 #include <memory>
+#include <set>
 #include <stack>
+#include <utility>
 #include <vector>
 
 // *****************************************************************************
@@ -99,6 +102,12 @@ namespace Exiv2 {
 
     //! Type for a list of primary image groups
     using PrimaryGroups = std::vector<IfdId>;
+
+    //! Type for a set of groups (directories) which were modified by the encoder
+    using DirtyGroups = std::set<IfdId>;
+
+    //! Type for an index of the entries of a TIFF tree by group and tag
+    using TiffEntryIndex = std::map<std::pair<IfdId, uint16_t>, const TiffEntryBase*>;
 }}                                      // namespace Internal, Exiv2
 
 #endif                                  // #ifndef TIFFFWD_INT_HPP_
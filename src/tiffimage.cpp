@@ -30,6 +30,7 @@
 #include "nikonmn_int.hpp"
 #include "image.hpp"
 #include "image_int.hpp"
+#include "structindex_int.hpp"
 #include "error.hpp"
 #include "futils.hpp"
 #include "types.hpp"
@@ -186,9 +187,28 @@ namespace Exiv2 {
         }
         clearMetadata();
 
-        ByteOrder bo =
-            TiffParser::decode(exifData_, iptcData_, xmpData_, io_->mmap(), static_cast<uint32_t>(io_->size()));
+        // Hint IFD0 (assuming up to 64 entries) to remote IO, it is fetched
+        // when the file is mapped
+        byte buf[8];
+        TiffHeader tiffHeader;
+        if (io_->read(buf, 8) == 8 && tiffHeader.read(buf, 8)) {
+            io_->prefetch(static_cast<long>(tiffHeader.offset()), 2 + 64 * 12 + 4);
+        }
+        io_->seek(0, BasicIo::beg);
+
+        // Request the parts of a local file which were parsed the last time
+        // all at once, if the file is unchanged and indexed
+        StructureIndex index(dynamic_cast<FileIo*>(io_.get()) ? getEnv(envINDEXCACHE) : std::string(), io_->path());
+        for (auto&& range : index.ranges()) {
+            io_->prefetch(range.first, range.second);
+        }
+
+        // Only the parts of the file which are parsed are read from remote IO
+        ByteOrder bo = TiffParserWorker::decode(exifData_, iptcData_, xmpData_, io_->mmapSparse(),
+                                                static_cast<uint32_t>(io_->size()), Tag::root,
+                                                TiffMapping::findDecoder, nullptr, io_.get(), index.recorder());
         setByteOrder(bo);
+        index.save();
 
         // read profile from the metadata
         Exiv2::ExifKey            key("Exif.Image.InterColorProfile");
@@ -241,8 +261,9 @@ namespace Exiv2 {
             if ( found ) exifData_.erase(pos);
         }
 
-        // set usePacket to influence TiffEncoder::encodeXmp() called by TiffVisitor.encode()
-        xmpData().usePacket(writeXmpFromPacket());
+        // set usePacket to influence TiffEncoder::encodeXmp() called by TiffVisitor.encode(),
+        // which passes the packet of the XMP metadata through if they were never accessed
+        xmpData().usePacket(writeXmpFromPacket() || xmpData_.decodePending());
 
         TiffParser::encode(*io_, pData, size, bo, exifData_, iptcData_, xmpData_); // may throw
     } // TiffImage::writeMetadata
@@ -24,8 +24,16 @@
 #include "sonymn_int.hpp"
 #include "tags_int.hpp"
 #include "tiffvisitor_int.hpp"
+#include "futils.hpp"
 #include "i18n.h"                // NLS support.
 
+// + standard includes
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
 // Shortcuts for the newTiffBinaryArray templates.
 #define EXV_BINARY_ARRAY(arrayCfg, arrayDef) (newTiffBinaryArray0<&arrayCfg, EXV_COUNTOF(arrayDef), arrayDef>)
 #define EXV_SIMPLE_BINARY_ARRAY(arrayCfg) (newTiffBinaryArray1<&arrayCfg>)
@@ -1768,13 +1776,78 @@ namespace Exiv2 {
         {"*", 0x0026, canonId, &TiffDecoder::decodeCanonAFInfo, nullptr /* Exiv2.Canon.AFInfo is read-only */},
     };
 
+    namespace {
+        //! Return the key of \em group and \em tag in the indexes of the TIFF tables
+        uint64_t indexKey(IfdId group, uint32_t tag)
+        {
+            return static_cast<uint64_t>(group) << 32 | tag;
+        }
+
+        /*!
+          @brief Index of a table with extendedTag_ and group_ columns, like the
+                 TIFF group structure and the TIFF mapping table. The rows of
+                 a group and tag are found by a hash lookup instead of a linear
+                 search of the table. A row with Tag::all matches all tags of
+                 its group.
+         */
+        template <typename T>
+        class TagGroupIndex {
+        public:
+            //! Constructor, indexing the rows of \em table
+            template <size_t N>
+            explicit TagGroupIndex(const T (&table)[N])
+            {
+                for (auto&& row : table) {
+                    rows_[indexKey(row.group_, row.extendedTag_)].push_back(&row);
+                }
+            }
+
+            /*!
+              @brief Return the first row of the table with \em group and
+                     \em extendedTag or Tag::all, for which \em match is
+                     true, i.e., the row which a linear search finds.
+                     Return 0 if there is none.
+             */
+            template <typename Match>
+            const T* find(uint32_t extendedTag, IfdId group, Match match) const
+            {
+                const std::vector<const T*>& tagRows = rows(group, extendedTag);
+                const std::vector<const T*>& allRows = rows(group, Tag::all);
+                // Merge the two lists in the order of the table
+                auto t = tagRows.begin();
+                auto a = allRows.begin();
+                while (t != tagRows.end() || a != allRows.end()) {
+                    const T* row = nullptr;
+                    if (a == allRows.end() || (t != tagRows.end() && *t < *a)) {
+                        row = *t++;
+                    } else {
+                        row = *a++;
+                    }
+                    if (match(*row)) return row;
+                }
+                return nullptr;
+            }
+
+        private:
+            //! Return the rows with \em group and \em tag in the order of the table
+            const std::vector<const T*>& rows(IfdId group, uint32_t tag) const
+            {
+                static const std::vector<const T*> none;
+                auto pos = rows_.find(indexKey(group, tag));
+                return pos == rows_.end() ? none : pos->second;
+            }
+
+            // DATA
+            std::unordered_map<uint64_t, std::vector<const T*> > rows_; //!< Rows by group and tag
+        };
+    }
+
     DecoderFct TiffMapping::findDecoder(const std::string& make,
                                               uint32_t     extendedTag,
                                               IfdId        group)
     {
         DecoderFct decoderFct = &TiffDecoder::decodeStdTiffEntry;
-        const TiffMappingInfo* td = find(tiffMappingInfo_,
-                                         TiffMappingInfo::Key(make, extendedTag, group));
+        const TiffMappingInfo* td = findMappingInfo(make, extendedTag, group);
         if (td) {
             // This may set decoderFct to 0, meaning that the tag should not be decoded
             decoderFct = td->decoderFct_;
@@ -1789,8 +1862,7 @@ namespace Exiv2 {
     )
     {
         EncoderFct encoderFct = nullptr;
-        const TiffMappingInfo* td = find(tiffMappingInfo_,
-                                         TiffMappingInfo::Key(make, extendedTag, group));
+        const TiffMappingInfo* td = findMappingInfo(make, extendedTag, group);
         if (td) {
             // Returns 0 if no special encoder function is found
             encoderFct = td->encoderFct_;
@@ -1798,6 +1870,17 @@ namespace Exiv2 {
         return encoderFct;
     }
 
+    const TiffMappingInfo* TiffMapping::findMappingInfo(const std::string& make,
+                                                              uint32_t     extendedTag,
+                                                              IfdId        group)
+    {
+        static const TagGroupIndex<TiffMappingInfo> index(tiffMappingInfo_);
+        // Only the few rows for the group and tag are compared with the make
+        return index.find(extendedTag, group, [&](const TiffMappingInfo& row) {
+            return row == TiffMappingInfo::Key(make, extendedTag, group);
+        });
+    }
+
     bool TiffTreeStruct::operator==(const TiffTreeStruct::Key& key) const
     {
         return key.r_ == root_ && key.g_ == group_;
@@ -1806,10 +1889,10 @@ namespace Exiv2 {
     TiffComponent::UniquePtr TiffCreator::create(uint32_t extendedTag,
                                                IfdId    group)
     {
+        static const TagGroupIndex<TiffGroupStruct> index(tiffGroupStruct_);
         TiffComponent::UniquePtr tc;
         auto tag = static_cast<uint16_t>(extendedTag & 0xffff);
-        const TiffGroupStruct* ts = find(tiffGroupStruct_,
-                                         TiffGroupStruct::Key(extendedTag, group));
+        const TiffGroupStruct* ts = index.find(extendedTag, group, [](const TiffGroupStruct&) { return true; });
         if (ts && ts->newTiffCompFct_) {
             tc = ts->newTiffCompFct_(tag, group);
         }
@@ -1834,10 +1917,19 @@ namespace Exiv2 {
                               IfdId     group,
                               uint32_t  root)
     {
+        // Index of the TIFF tree structure by group and root, with the first row of each
+        static const std::unordered_map<uint64_t, const TiffTreeStruct*> index = [] {
+            std::unordered_map<uint64_t, const TiffTreeStruct*> rows;
+            for (auto&& row : tiffTreeStruct_) {
+                rows.emplace(indexKey(row.group_, row.root_), &row);
+            }
+            return rows;
+        }();
         const TiffTreeStruct* ts = nullptr;
         do {
             tiffPath.push(TiffPathItem(extendedTag, group));
-            ts = find(tiffTreeStruct_, TiffTreeStruct::Key(root, group));
+            auto pos = index.find(indexKey(group, root));
+            ts = pos == index.end() ? nullptr : pos->second;
             assert(ts != 0);
             extendedTag = ts->parentExtTag_;
             group = ts->parentGroup_;
@@ -1853,7 +1945,9 @@ namespace Exiv2 {
               uint32_t           size,
               uint32_t           root,
               FindDecoderFct     findDecoderFct,
-              TiffHeaderBase*    pHeader
+              TiffHeaderBase*    pHeader,
+              BasicIo*           pIo,
+              FileRanges*        pRanges
     )
     {
         // Create standard TIFF header if necessary
@@ -1862,19 +1956,110 @@ namespace Exiv2 {
             ph = std::unique_ptr<TiffHeaderBase>(new TiffHeader);
             pHeader = ph.get();
         }
-        TiffComponent::UniquePtr rootDir = parse(pData, size, root, pHeader);
+        TiffComponent::UniquePtr rootDir = parse(pData, size, root, pHeader, pIo, pRanges);
         if (nullptr != rootDir.get()) {
-            TiffDecoder decoder(exifData,
-                                iptcData,
-                                xmpData,
-                                rootDir.get(),
-                                findDecoderFct);
-            rootDir->accept(decoder);
+            const long threads = atol(getEnv(envDECODETHREADS).c_str());
+            auto pRootDir = dynamic_cast<TiffDirectory*>(rootDir.get());
+            if (threads > 1 && pRootDir && exifData.empty()) {
+                decodeDirectories(exifData, iptcData, xmpData, pRootDir, findDecoderFct, threads);
+            } else {
+                TiffDecoder decoder(exifData,
+                                    iptcData,
+                                    xmpData,
+                                    rootDir.get(),
+                                    findDecoderFct);
+                rootDir->accept(decoder);
+            }
         }
         return pHeader->byteOrder();
 
     } // TiffParserWorker::decode
 
+    void TiffParserWorker::decodeDirectories(
+              ExifData&          exifData,
+              IptcData&          iptcData,
+              XmpData&           xmpData,
+              TiffDirectory*     pRoot,
+              FindDecoderFct     findDecoderFct,
+              long               threads
+    )
+    {
+        const std::string make = TiffDecoder::findMake(exifData, pRoot);
+        TiffDecoder rootDecoder(exifData, iptcData, xmpData, pRoot, findDecoderFct, make, pRoot);
+        pRoot->accept(rootDecoder);
+        const std::vector<TiffDirectory*>& dirs = rootDecoder.directories();
+        if (dirs.empty()) return;
+
+        struct Part {
+            ExifData exifData;
+            IptcData iptcData;
+            XmpData xmpData;
+            TiffDecoder::Nested nested;
+            std::exception_ptr error;
+        };
+        std::vector<Part> parts(dirs.size());
+        std::atomic<size_t> next(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < dirs.size(); i = next++) {
+                Part& part = parts[i];
+                try {
+                    TiffDecoder decoder(part.exifData, part.iptcData, part.xmpData,
+                                        pRoot, findDecoderFct, make, dirs[i]);
+                    dirs[i]->accept(decoder);
+                    part.nested = decoder.nested();
+                } catch (...) {
+                    part.error = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        const size_t count = std::min(static_cast<size_t>(threads), dirs.size());
+        for (size_t i = 1; i < count; ++i) {
+            try {
+                pool.emplace_back(work);
+            } catch (const std::system_error&) {
+                break;  // the others do the work
+            }
+        }
+        work();
+        for (auto&& thread : pool) {
+            thread.join();
+        }
+        for (auto&& part : parts) {
+            if (part.error) std::rethrow_exception(part.error);
+        }
+
+        // Move the Exif metadata of each directory into the directory it is
+        // nested in, the innermost first, as nested directories follow later
+        std::map<const TiffDirectory*, size_t> index;
+        for (size_t i = 0; i < dirs.size(); ++i) {
+            index[dirs[i]] = i;
+        }
+        auto splice = [&](ExifData& target, const TiffDecoder::Nested& nested) {
+            auto pos = target.begin();
+            long n = 0;
+            for (auto&& dir : nested) {
+                for (; n < dir.first; ++n) ++pos;
+                target.splice(pos, parts[index[dir.second]].exifData);
+            }
+        };
+        for (size_t i = dirs.size(); i-- > 0;) {
+            splice(parts[i].exifData, parts[i].nested);
+        }
+        splice(exifData, rootDecoder.nested());
+
+        // Only IFD0 has IPTC and XMP tags, keep those of other directories anyway
+        for (auto&& part : parts) {
+            for (auto&& iptcDatum : part.iptcData) {
+                iptcData.add(iptcDatum);
+            }
+            if (!part.xmpData.xmpPacket().empty()) {
+                xmpData.setPacketDeferred(part.xmpData.xmpPacket());
+            }
+        }
+
+    } // TiffParserWorker::decodeDirectories
+
     WriteMethod TiffParserWorker::encode(
               BasicIo&           io,
         const byte*              pData,
@@ -1893,7 +2078,8 @@ namespace Exiv2 {
            2) attempt updating the parsed tree in-place ("non-intrusive writing")
            3) else, create a new tree and write a new TIFF structure ("intrusive
               writing"). If there is a parsed tree, it is only used to access the
-              image data in this case.
+              image data and the value data of groups which were not modified in
+              step 2 in this case.
          */
         assert(pHeader);
         assert(pHeader->byteOrder() != invalidByteOrder);
@@ -1901,6 +2087,7 @@ namespace Exiv2 {
         TiffComponent::UniquePtr parsedTree = parse(pData, size, root, pHeader);
         PrimaryGroups primaryGroups;
         findPrimaryGroups(primaryGroups, parsedTree.get());
+        TiffEntryIndex cleanEntries;
         if (nullptr != parsedTree.get()) {
             // Attempt to update existing TIFF components based on metadata entries
             TiffEncoder encoder(exifData,
@@ -1913,6 +2100,7 @@ namespace Exiv2 {
                                 findEncoderFct);
             parsedTree->accept(encoder);
             if (!encoder.dirty()) writeMethod = wmNonIntrusive;
+            else cleanEntries = encoder.cleanEntries();
         }
         if (writeMethod == wmIntrusive) {
             TiffComponent::UniquePtr createdTree = TiffCreator::create(root, ifdIdNotSet);
@@ -1924,7 +2112,8 @@ namespace Exiv2 {
             // Add entries from metadata to composite
             TiffEncoder encoder(exifData, iptcData, xmpData, createdTree.get(), parsedTree.get() == nullptr,
                                 &primaryGroups, pHeader, findEncoderFct);
-            encoder.add(createdTree.get(), parsedTree.get(), root);
+            // Values of entries in groups which were not dirty are copied from the parsed tree
+            encoder.add(createdTree.get(), parsedTree.get(), root, &cleanEntries);
             // Write binary representation from the composite tree
             DataBuf header = pHeader->write();
             BasicIo::UniquePtr tempIo(new MemIo);
@@ -1955,11 +2144,15 @@ namespace Exiv2 {
         const byte*              pData,
               uint32_t           size,
               uint32_t           root,
-              TiffHeaderBase*    pHeader
+              TiffHeaderBase*    pHeader,
+              BasicIo*           pIo,
+              FileRanges*        pRanges
     )
     {
         if (pData == nullptr || size == 0)
             return nullptr;
+        if (pIo) pIo->populateMap(0, pHeader->size());
+        if (pRanges) pRanges->emplace_back(0, pHeader->size());
         if (!pHeader->read(pData, size) || pHeader->offset() >= size) {
             throw Error(kerNotAnImage, "TIFF");
         }
@@ -1967,7 +2160,7 @@ namespace Exiv2 {
         if (nullptr != rootDir.get()) {
             rootDir->setStart(pData + pHeader->offset());
             TiffRwState state(pHeader->byteOrder(), 0);
-            TiffReader reader(pData, size, rootDir.get(), state);
+            TiffReader reader(pData, size, rootDir.get(), state, pIo, pRanges);
             rootDir->accept(reader);
             reader.postProcess();
         }
@@ -25,6 +25,7 @@
 #include "tifffwd_int.hpp"
 #include "tiffcomposite_int.hpp"
 #include "image.hpp"
+#include "structindex_int.hpp"
 #include "tags_int.hpp"
 #include "types.hpp"
 
@@ -289,6 +290,15 @@ namespace Exiv2 {
           @param findDecoderFct Function to access special decoding info.
           @param pHeader   Optional pointer to a TIFF header. If not provided,
                            a standard TIFF header is used.
+          @param pIo       Optional IO the data buffer was mapped from with
+                           BasicIo::mmapSparse(). The parts of the buffer
+                           which are read are populated first.
+          @param pRanges   Optional list to which the ranges of the data
+                           buffer which are read are added.
+
+          The directories are decoded in parallel if the environment variable
+          EXIV2_DECODE_THREADS is greater than 1 and \em exifData is empty,
+          see decodeDirectories().
 
           @return Byte order in which the data is encoded, invalidByteOrder if
                   decoding failed.
@@ -301,7 +311,9 @@ namespace Exiv2 {
                   uint32_t           size,
                   uint32_t           root,
                   FindDecoderFct     findDecoderFct,
-                  TiffHeaderBase*    pHeader =0
+                  TiffHeaderBase*    pHeader =0,
+                  BasicIo*           pIo =nullptr,
+                  FileRanges*        pRanges =nullptr
         );
         /*!
           @brief Encode TIFF metadata from the metadata containers into a
@@ -336,6 +348,9 @@ namespace Exiv2 {
           @param size      Length of the data buffer.
           @param root      Root tag of the TIFF tree.
           @param pHeader   Pointer to a TIFF header.
+          @param pIo       Optional IO of a sparsely mapped data buffer.
+          @param pRanges   Optional list of the ranges of the data buffer
+                           which are read.
           @return          An auto pointer with the root element of the TIFF
                            composite structure. If \em pData is 0 or \em size
                            is 0, the return value is a 0 pointer.
@@ -344,7 +359,9 @@ namespace Exiv2 {
             const byte*              pData,
                   uint32_t           size,
                   uint32_t           root,
-                  TiffHeaderBase*    pHeader
+                  TiffHeaderBase*    pHeader,
+                  BasicIo*           pIo =nullptr,
+                  FileRanges*        pRanges =nullptr
         );
         /*!
           @brief Find primary groups in the source tree provided and populate
@@ -357,6 +374,26 @@ namespace Exiv2 {
             PrimaryGroups& primaryGroups,
             TiffComponent* pSourceDir
         );
+        /*!
+          @brief Decode the TIFF composite with root directory \em pRoot
+                 like a TiffDecoder, with up to \em threads threads.
+
+          The root directory is decoded first, then the directories nested
+          in it are decoded in parallel, each into its own metadata
+          containers. Finally the Exif metadata of each directory is moved
+          to the position where a TiffDecoder of the whole composite adds
+          it, so the order of the metadata is the same.
+
+          @throw Error the first error of a directory, in the order of traversal
+         */
+        static void decodeDirectories(
+                  ExifData&          exifData,
+                  IptcData&          iptcData,
+                  XmpData&           xmpData,
+                  TiffDirectory*     pRoot,
+                  FindDecoderFct     findDecoderFct,
+                  long               threads
+        );
 
     }; // class TiffParserWorker
 
@@ -404,6 +441,11 @@ namespace Exiv2 {
         );
 
     private:
+        //! Return the row of the TIFF mapping table for a key, 0 if there is none
+        static const TiffMappingInfo* findMappingInfo(const std::string& make,
+                                                            uint32_t     extendedTag,
+                                                            IfdId        group);
+
         static const TiffMappingInfo tiffMappingInfo_[]; //<! TIFF mapping table
 
     }; // class TiffMapping
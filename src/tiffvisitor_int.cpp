@@ -270,24 +270,53 @@ namespace Exiv2 {
           xmpData_(xmpData),
           pRoot_(pRoot),
           findDecoderFct_(findDecoderFct),
-          decodedIptc_(false)
+          decodedIptc_(false),
+          pDir_(nullptr),
+          pSkip_(nullptr)
     {
         assert(pRoot != 0);
+        make_ = findMake(exifData_, pRoot_);
+    }
 
+    TiffDecoder::TiffDecoder(
+        ExifData&            exifData,
+        IptcData&            iptcData,
+        XmpData&             xmpData,
+        TiffComponent* const pRoot,
+        FindDecoderFct       findDecoderFct,
+        std::string          make,
+        const TiffDirectory* pDir
+    )
+        : exifData_(exifData),
+          iptcData_(iptcData),
+          xmpData_(xmpData),
+          pRoot_(pRoot),
+          findDecoderFct_(findDecoderFct),
+          make_(std::move(make)),
+          decodedIptc_(false),
+          pDir_(pDir),
+          pSkip_(nullptr)
+    {
+        assert(pRoot != 0);
+        assert(pDir != 0);
+    }
+
+    std::string TiffDecoder::findMake(const ExifData& exifData, TiffComponent* pRoot)
+    {
         // #1402 Fujifilm RAF. Search for the make
         // Find camera make in existing metadata (read from the JPEG)
         ExifKey key("Exif.Image.Make");
-        if ( exifData_.findKey(key) != exifData_.end( ) ){
-            make_ = exifData_.findKey(key)->toString();
-        } else {
-            // Find camera make by looking for tag 0x010f in IFD0
-            TiffFinder finder(0x010f, ifd0Id);
-            pRoot_->accept(finder);
-            auto te = dynamic_cast<TiffEntryBase*>(finder.result());
-            if (te && te->pValue()) {
-                make_ = te->pValue()->toString();
-            }
+        if ( exifData.findKey(key) != exifData.end( ) ){
+            return exifData.findKey(key)->toString();
+        }
+        // Find camera make by looking for tag 0x010f in IFD0
+        TiffFinder finder(0x010f, ifd0Id);
+        pRoot->accept(finder);
+        auto te = dynamic_cast<TiffEntryBase*>(finder.result());
+        if (te && te->pValue()) {
+            return te->pValue()->toString();
         }
+        return std::string();
     }
 
     void TiffDecoder::visitEntry(TiffEntry* object)
@@ -310,9 +339,20 @@ namespace Exiv2 {
         decodeTiffEntry(object);
     }
 
-    void TiffDecoder::visitDirectory(TiffDirectory* /* object */ )
+    void TiffDecoder::visitDirectory(TiffDirectory* object)
     {
-        // Nothing to do
+        if (pDir_ == nullptr || object == pDir_) return;
+        directories_.push_back(object);
+        // Another decoder decodes the nested directory and its next IFDs
+        if (pSkip_ == nullptr) {
+            pSkip_ = object;
+            nested_.emplace_back(exifData_.count(), object);
+        }
+    }
+
+    void TiffDecoder::visitDirectoryEnd(TiffDirectory* object)
+    {
+        if (object == pSkip_) pSkip_ = nullptr;
     }
 
     void TiffDecoder::visitSubIfd(TiffSubIfd* object)
@@ -329,6 +369,7 @@ namespace Exiv2 {
     void TiffDecoder::visitIfdMakernote(TiffIfdMakernote* object)
     {
         assert(object != 0);
+        if (pSkip_) return;
 
         exifData_["Exif.MakerNote.Offset"] = object->mnOffset();
         switch (object->byteOrder()) {
@@ -384,11 +425,7 @@ namespace Exiv2 {
 #endif
                 xmpPacket = xmpPacket.substr(idx);
             }
-            if (XmpParser::decode(xmpData_, xmpPacket)) {
-#ifndef SUPPRESS_WARNINGS
-                EXV_WARNING << "Failed to decode XMP metadata.\n";
-#endif
-            }
+            xmpData_.setPacketDeferred(xmpPacket);
         }
     } // TiffDecoder::decodeXmp
 
@@ -523,7 +560,7 @@ namespace Exiv2 {
         assert(object != 0);
 
         // Don't decode the entry if value is not set
-        if (!object->pValue()) return;
+        if (!object->pValue() || pSkip_) return;
 
         const DecoderFct decoderFct = findDecoderFct_(make_,
                                                       object->tag(),
@@ -569,6 +606,7 @@ namespace Exiv2 {
           pSourceTree_(nullptr),
           findEncoderFct_(findEncoderFct),
           dirty_(false),
+          pCleanEntries_(nullptr),
           writeMethod_(wmNonIntrusive)
     {
         assert(pRoot != 0);
@@ -688,13 +726,43 @@ namespace Exiv2 {
         setGo(geTraverse, !flag);
     }
 
+    void TiffEncoder::setDirty(IfdId group)
+    {
+        dirty_ = true;
+        dirtyGroups_.insert(group);
+    }
+
     bool TiffEncoder::dirty() const
     {
         return dirty_ || exifData_.count() > 0;
     }
 
+    DirtyGroups TiffEncoder::dirtyGroups() const
+    {
+        DirtyGroups dirtyGroups(dirtyGroups_);
+        // Remaining entries need to be added
+        for (auto&& md : exifData_) {
+            dirtyGroups.insert(groupId(md.groupName()));
+        }
+        return dirtyGroups;
+    }
+
+    TiffEntryIndex TiffEncoder::cleanEntries() const
+    {
+        const DirtyGroups dirty = dirtyGroups();
+        TiffEntryIndex cleanEntries;
+        for (auto&& entry : entries_) {
+            if (dirty.find(entry.first.first) == dirty.end()) cleanEntries.insert(entry);
+        }
+        return cleanEntries;
+    }
+
     void TiffEncoder::visitEntry(TiffEntry* object)
     {
+        // Makernote data may be written in a different byte order
+        if (writeMethod_ == wmNonIntrusive && object->group() < mnId) {
+            entries_.emplace(std::make_pair(object->group(), object->tag()), object);
+        }
         encodeTiffComponent(object);
     }
 
@@ -723,6 +791,9 @@ namespace Exiv2 {
         // Update type and count in IFD entries, in case they changed
         assert(object != 0);
 
+        // The tree is not modified anymore once it is dirty
+        if (dirty_) return;
+
         byte* p = object->start() + 2;
         for (auto&& component : object->components_) {
             p += updateDirEntry(p, byteOrder(), component);
@@ -780,8 +851,8 @@ namespace Exiv2 {
             // Set Makernote byte order
             ByteOrder bo = stringToByteOrder(pos->toString());
             if (bo != invalidByteOrder && bo != object->byteOrder()) {
-                object->setByteOrder(bo);
-                setDirty();
+                if (!dirty_) object->setByteOrder(bo);
+                setDirty(object->group());
             }
             if (del_) exifData_.erase(pos);
         }
@@ -818,7 +889,7 @@ namespace Exiv2 {
     {
         assert(object != 0);
 
-        if (object->cfg() == nullptr || !object->decoded())
+        if (object->cfg() == nullptr || !object->decoded() || dirty_)
             return;
         int32_t size = object->TiffEntryBase::doSize();
         if (size == 0) return;
@@ -837,7 +908,7 @@ namespace Exiv2 {
                 size = buf.size();
             }
             if (!object->updOrigDataBuf(pData, size)) {
-                setDirty();
+                setDirty(object->group());
             }
         }
     }
@@ -883,7 +954,7 @@ namespace Exiv2 {
                 }
             }
             else {
-                setDirty();
+                setDirty(object->group());
 #ifdef EXIV2_DEBUG_MESSAGES
                 std::cerr << "DELETING          " << key << ", idx = " << object->idx() << "\n";
 #endif
@@ -895,7 +966,11 @@ namespace Exiv2 {
         }
         // Skip encoding image tags of existing TIFF image - they were copied earlier -
         // but encode image tags of new images (creation)
-        if (ed && !isImageTag(object->tag(), object->group())) {
+        if (ed && !isImageTag(object->tag(), object->group()) && dirty_ && writeMethod() == wmNonIntrusive) {
+            // The tree will be written intrusively, only find out if the group changed
+            if (!isUnchanged(object, ed)) setDirty(object->group());
+        }
+        else if (ed && !isImageTag(object->tag(), object->group())) {
             const EncoderFct fct = findEncoderFct_(make_, object->tag(), object->group());
             if (fct) {
                 // If an encoding function is registered for the tag, use it
@@ -938,7 +1013,7 @@ namespace Exiv2 {
                 ExifKey key(object->tag(), groupName(object->group()));
                 std::cerr << "DATAAREA GREW     " << key << "\n";
 #endif
-                setDirty();
+                setDirty(object->group());
             }
             else {
                 // Write the new dataarea, fill with 0x0
@@ -961,6 +1036,7 @@ namespace Exiv2 {
 
     void TiffEncoder::encodeTiffEntry(TiffEntry* object, const Exifdatum* datum)
     {
+        if (writeMethod() == wmIntrusive && copyVerbatim(object, datum)) return;
         encodeTiffEntryBase(object, datum);
     } // TiffEncoder::encodeTiffEntry
 
@@ -974,7 +1050,7 @@ namespace Exiv2 {
 #ifdef EXIV2_DEBUG_MESSAGES
             std::cerr << "\t DATAAREA IS SET (NON-INTRUSIVE WRITING)";
 #endif
-            setDirty();
+            setDirty(object->group());
         }
 
         if (sizeDataArea > 0 && writeMethod() == wmIntrusive) {
@@ -1062,7 +1138,7 @@ namespace Exiv2 {
 #endif
         uint32_t newSize = datum->size();
         if (newSize > object->size_) { // value doesn't fit, encode for intrusive writing
-            setDirty();
+            setDirty(object->group());
 #ifdef EXIV2_DEBUG_MESSAGES
             tooLarge = true;
 #endif
@@ -1077,6 +1153,49 @@ namespace Exiv2 {
 #endif
     } // TiffEncoder::encodeTiffEntryBase
 
+    bool TiffEncoder::isUnchanged(const TiffEntryBase* object, const Exifdatum* datum) const
+    {
+        assert(object != 0);
+        assert(datum != 0);
+
+        // Makernote groups are never copied, no need to look at them
+        if (object->group() >= mnId) return false;
+        const uint32_t size = datum->size();
+        if (object->pData() == nullptr || object->size() != size) return false;
+        DataBuf buf(size);
+        datum->copy(buf.data(), byteOrder());
+        return buf.cmpBytes(0, object->pData(), size) == 0;
+    } // TiffEncoder::isUnchanged
+
+    bool TiffEncoder::copyVerbatim(TiffEntryBase* object, const Exifdatum* datum)
+    {
+        assert(object != 0);
+        assert(datum != 0);
+
+        if (pCleanEntries_ == nullptr) return false;
+        // Only values which don't fit into the directory entry are worth it
+        const uint32_t size = datum->size();
+        if (size <= 4) return false;
+
+        auto pos = pCleanEntries_->find(std::make_pair(object->group(), object->tag()));
+        if (pos == pCleanEntries_->end()) return false;
+        const TiffEntryBase* src = pos->second;
+        if (   src->pData() == nullptr
+            || src->idx() != datum->idx()
+            || src->size() != size
+            || src->count() != static_cast<uint32_t>(datum->count())
+            || src->tiffType() != toTiffType(datum->typeId())) {
+            return false;
+        }
+        // In a clean group, the data is either unchanged or was updated in-place
+        object->setVerbatimData(*src);
+#ifdef EXIV2_DEBUG_MESSAGES
+        ExifKey key(object->tag(), groupName(object->group()));
+        std::cerr << "COPYING DATA      " << key;
+#endif
+        return true;
+    } // TiffEncoder::copyVerbatim
+
     void TiffEncoder::encodeOffsetEntry(TiffEntryBase* object, const Exifdatum* datum)
     {
         assert(object != 0);
@@ -1084,7 +1203,7 @@ namespace Exiv2 {
 
         uint32_t newSize = datum->size();
         if (newSize > object->size_) { // value doesn't fit, encode for intrusive writing
-            setDirty();
+            setDirty(object->group());
             object->updateValue(datum->getValue(), byteOrder()); // clones the value
 #ifdef EXIV2_DEBUG_MESSAGES
             ExifKey key(object->tag(), groupName(object->group()));
@@ -1104,15 +1223,17 @@ namespace Exiv2 {
     } // TiffEncoder::encodeOffsetEntry
 
     void TiffEncoder::add(
-        TiffComponent* pRootDir,
-        TiffComponent* pSourceDir,
-        uint32_t       root
+              TiffComponent* pRootDir,
+              TiffComponent* pSourceDir,
+              uint32_t       root,
+        const TiffEntryIndex* pCleanEntries
     )
     {
         assert(pRootDir != 0);
 
         writeMethod_ = wmIntrusive;
         pSourceTree_ = pSourceDir;
+        pCleanEntries_ = pCleanEntries;
 
         // Ensure that the exifData_ entries are not deleted, to be able to
         // iterate over all remaining entries.
@@ -1179,14 +1300,18 @@ namespace Exiv2 {
     TiffReader::TiffReader(const byte*    pData,
                            uint32_t       size,
                            TiffComponent* pRoot,
-                           TiffRwState    state)
+                           TiffRwState    state,
+                           BasicIo*       pIo,
+                           FileRanges*    pRanges)
         : pData_(pData),
           size_(size),
           pLast_(pData + size),
           pRoot_(pRoot),
           origState_(state),
           mnState_(state),
-          postProc_(false)
+          postProc_(false),
+          pIo_(pIo),
+          pRanges_(pRanges)
     {
         pState_ = &origState_;
         assert(pData_);
@@ -1225,6 +1350,42 @@ namespace Exiv2 {
         return pState_->baseOffset();
     }
 
+    void TiffReader::populateMap(const byte* p, size_t size)
+    {
+        if (p < pData_ || p >= pLast_) return;
+        size = std::min(size, static_cast<size_t>(pLast_ - p));
+        if (pRanges_) pRanges_->emplace_back(static_cast<long>(p - pData_), static_cast<long>(size));
+        if (pIo_) pIo_->populateMap(static_cast<long>(p - pData_), static_cast<long>(size));
+    }
+
+    void TiffReader::prefetchValues(const byte* p, uint16_t n)
+    {
+        // Announce the values which do not fit into the entries, so that they
+        // are read together with the first one
+        if (pIo_ == nullptr) return;
+        for (uint16_t i = 0; i < n && p + 12 <= pLast_; ++i, p += 12) {
+            const long typeSize = TypeInfo::typeSize(static_cast<TypeId>(getUShort(p + 2, byteOrder())));
+            const uint64_t size = static_cast<uint64_t>(typeSize) * getULong(p + 4, byteOrder());
+            const uint64_t offset = static_cast<uint64_t>(baseOffset()) + getULong(p + 8, byteOrder());
+            if (size <= 4 || size > size_ || offset >= size_) continue;
+            pIo_->prefetch(static_cast<long>(offset), static_cast<long>(size));
+        }
+    }
+
+    void TiffReader::populateDataArea(TiffDataEntryBase* object, const Value* pSize)
+    {
+        // The data area of a TiffDataEntry is copied by setStrips(), image data is not
+        if ((pIo_ == nullptr && pRanges_ == nullptr) || dynamic_cast<TiffDataEntry*>(object) == nullptr) return;
+        if (!object->pValue() || object->pValue()->count() == 0 || !pSize) return;
+        uint64_t size = 0;
+        for (long i = 0; i < pSize->count(); ++i) {
+            size += static_cast<uint32_t>(pSize->toLong(i));
+        }
+        const uint64_t offset = static_cast<uint64_t>(baseOffset()) + static_cast<uint32_t>(object->pValue()->toLong(0));
+        if (offset >= size_ || size > size_) return;
+        populateMap(pData_ + offset, static_cast<size_t>(size));
+    }
+
     void TiffReader::readDataEntryBase(TiffDataEntryBase* object)
     {
         assert(object != 0);
@@ -1234,6 +1395,7 @@ namespace Exiv2 {
         pRoot_->accept(finder);
         auto te = dynamic_cast<TiffEntryBase*>(finder.result());
         if (te && te->pValue()) {
+            populateDataArea(object, te->pValue());
             object->setStrips(te->pValue(), pData_, size_, baseOffset());
         }
     }
@@ -1262,6 +1424,7 @@ namespace Exiv2 {
         pRoot_->accept(finder);
         auto te = dynamic_cast<TiffDataEntryBase*>(finder.result());
         if (te && te->pValue()) {
+            populateDataArea(te, object->pValue());
             te->setStrips(object->pValue(), pData_, size_, baseOffset());
         }
     }
@@ -1312,6 +1475,7 @@ namespace Exiv2 {
 #endif
             return;
         }
+        populateMap(p, 2);
         const uint16_t n = getUShort(p, byteOrder());
         p += 2;
         // Sanity check with an "unreasonably" large number
@@ -1322,6 +1486,8 @@ namespace Exiv2 {
 #endif
             return;
         }
+        populateMap(p, n * 12 + 4);
+        prefetchValues(p, n);
         for (uint16_t i = 0; i < n; ++i) {
             if (p + 12 > pLast_) {
 #ifndef SUPPRESS_WARNINGS
@@ -1505,6 +1671,7 @@ namespace Exiv2 {
 #endif
             return;
         }
+        populateMap(p, 12);
         // Component already has tag
         p += 2;
         TiffType tiffType = getUShort(p, byteOrder());
@@ -1593,6 +1760,7 @@ namespace Exiv2 {
                 size = 0;
             }
         }
+        if (size > 4) populateMap(pData, size);
         Value::UniquePtr v = Value::create(typeId);
         enforce(v.get() != nullptr, kerCorruptedMetadata);
         if ( !isize ) {
@@ -23,6 +23,7 @@
 // *****************************************************************************
 // included header files
 #include "exif.hpp"
+#include "structindex_int.hpp"
 #include "tifffwd_int.hpp"
 #include "types.hpp"
 
@@ -34,12 +35,14 @@
 #include <cassert>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 // *****************************************************************************
 // namespace extensions
 namespace Exiv2 {
 
+    class BasicIo;
     class IptcData;
     class XmpData;
 
@@ -273,9 +276,18 @@ namespace Exiv2 {
              add it to an Image, which is supplied in the constructor (Visitor
              pattern). Used by TiffParser to decode the metadata from a
              TIFF composite.
+
+      A decoder can also decode a single directory of the composite, without
+      the directories nested in it, so that the directories of a composite
+      can be decoded in parallel. The metadata of each nested directory is
+      decoded by another decoder and belongs to the position in the
+      metadata container which is recorded in nested().
      */
     class TiffDecoder : public TiffVisitor {
     public:
+        //! Directories nested in the decoded directory, with the number of Exif metadata decoded before each
+        using Nested = std::vector<std::pair<long, const TiffDirectory*> >;
+
         //! @name Creators
         //@{
         /*!
@@ -290,6 +302,20 @@ namespace Exiv2 {
             TiffComponent* const pRoot,
             FindDecoderFct       findDecoderFct
         );
+        /*!
+          @brief Constructor for a decoder of the directory \em pDir of the
+                 composite \em pRoot only, which is passed to pDir->accept().
+                 \em make is the camera make of the composite, see findMake().
+         */
+        TiffDecoder(
+            ExifData&            exifData,
+            IptcData&            iptcData,
+            XmpData&             xmpData,
+            TiffComponent* const pRoot,
+            FindDecoderFct       findDecoderFct,
+            std::string          make,
+            const TiffDirectory* pDir
+        );
         //! Virtual destructor
         ~TiffDecoder() override = default;
         //@}
@@ -306,6 +332,8 @@ namespace Exiv2 {
         void visitSizeEntry(TiffSizeEntry* object) override;
         //! Decode a TIFF directory
         void visitDirectory(TiffDirectory* object) override;
+        //! End of a TIFF directory, the end of a nested directory which is skipped
+        void visitDirectoryEnd(TiffDirectory* object) override;
         //! Decode a TIFF sub-IFD
         void visitSubIfd(TiffSubIfd* object) override;
         //! Decode a TIFF makernote
@@ -329,6 +357,20 @@ namespace Exiv2 {
         void decodeCanonAFInfo(const TiffEntryBase* object);
         //@}
 
+        //! @name Accessors
+        //@{
+        //! Return the directories directly nested in the decoded directory, in the order of traversal
+        const Nested& nested() const { return nested_; }
+        //! Return all directories nested in the decoded directory, in the order of traversal
+        const std::vector<TiffDirectory*>& directories() const { return directories_; }
+        //@}
+
+        /*!
+          @brief Return the camera make of the composite \em pRoot, from the
+                 Exif metadata \em exifData if it has one, else from IFD0.
+         */
+        static std::string findMake(const ExifData& exifData, TiffComponent* pRoot);
+
     private:
         //! @name Manipulators
         //@{
@@ -356,6 +398,10 @@ namespace Exiv2 {
         const FindDecoderFct findDecoderFct_; //!< Ptr to the function to find special decoding functions
         std::string make_;           //!< Camera make, determined from the tags to decode
         bool decodedIptc_;           //!< Indicates if IPTC has been decoded yet
+        const TiffDirectory* pDir_;  //!< Directory to decode, 0 to decode the whole composite
+        const TiffDirectory* pSkip_; //!< Nested directory which is skipped, if any
+        Nested nested_;              //!< Directories directly nested in pDir_
+        std::vector<TiffDirectory*> directories_;    //!< All directories nested in pDir_
 
     }; // class TiffDecoder
 
@@ -477,18 +523,29 @@ namespace Exiv2 {
           if necessary and populated using encodeTiffComponent(). The add() function
           is used during intrusive writing, to create a new TIFF structure.
 
+          If \em pCleanEntries is provided, the value data of entries which
+          are in that index is copied as is from the entry of the source tree,
+          rather than re-encoded from the metadatum. See cleanEntries().
+
           @note For non-intrusive writing, the encoder is used as a visitor (by
           passing it to the accept() member of a TiffComponent). The composite
           tree is then traversed and metadata from the image is used to encode
           each existing component.
         */
         void add(
-            TiffComponent* pRootDir,
-            TiffComponent* pSourceDir,
-            uint32_t       root
+                  TiffComponent* pRootDir,
+                  TiffComponent* pSourceDir,
+                  uint32_t       root,
+            const TiffEntryIndex* pCleanEntries =0
         );
         //! Set the dirty flag and end of traversing signal.
         void setDirty(bool flag =true);
+        /*!
+          @brief Set the dirty flag and mark \em group as modified. Traversing
+                 continues, so that the state of all groups is known at the end,
+                 but the tree is not modified anymore.
+         */
+        void setDirty(IfdId group);
         //@}
 
         //! @name Accessors
@@ -503,6 +560,18 @@ namespace Exiv2 {
                  visiting a TIFF composite tree.
          */
         bool dirty() const;
+        /*!
+          @brief Return the groups in which a tag was deleted, allocated or
+                 is still to be added in the process of visiting a TIFF
+                 composite tree. All other groups were at most updated in-place.
+         */
+        DirtyGroups dirtyGroups() const;
+        /*!
+          @brief Return the entries of the visited tree in groups which are
+                 not dirty, see dirtyGroups(). Their value data can be copied
+                 as it is when the tree is written intrusively.
+         */
+        TiffEntryIndex cleanEntries() const;
         //! Return the write method used.
         WriteMethod writeMethod() const { return writeMethod_; }
         //@}
@@ -541,6 +610,23 @@ namespace Exiv2 {
                  it's actually present in the existing image doesn't matter.
          */
         bool isImageTag(uint16_t tag, IfdId group) const;
+        /*!
+          @brief Check if \em datum encodes to the same data as the value data
+                 of \em object. Always false for makernote groups.
+         */
+        bool isUnchanged(const TiffEntryBase* object, const Exifdatum* datum) const;
+        //@}
+
+        //! @name Manipulators
+        //@{
+        /*!
+          @brief Use the value data of the corresponding entry in the source tree
+                 for \em object, if the entry is one of the clean entries and the
+                 data has the size, type and count of \em datum. Return true if
+                 the data was copied, false if \em object still needs to be
+                 encoded.
+         */
+        bool copyVerbatim(TiffEntryBase* object, const Exifdatum* datum);
         //@}
 
     private:
@@ -559,6 +645,9 @@ namespace Exiv2 {
         const FindEncoderFct findEncoderFct_; //!< Ptr to the function to find special encoding functions
         std::string make_;           //!< Camera make, determined from the tags to encode
         bool dirty_;                 //!< Signals if any tag is deleted or allocated
+        DirtyGroups dirtyGroups_;    //!< Groups in which a tag is deleted or allocated
+        TiffEntryIndex entries_;     //!< Entries of the visited tree, for non-intrusive writing
+        const TiffEntryIndex* pCleanEntries_; //!< Clean entries of the source tree, for intrusive writing
         WriteMethod writeMethod_;    //!< Write method used.
 
     }; // class TiffEncoder
@@ -623,11 +712,18 @@ namespace Exiv2 {
           @param pRoot     Root element of the TIFF composite.
           @param state     State object for creation function, byte order and
                            base offset.
+          @param pIo       IO the data buffer was mapped from with
+                           BasicIo::mmapSparse(), if any. The parts of the
+                           buffer are populated before they are read.
+          @param pRanges   Optional list to which the ranges of the data
+                           buffer are added as they are read.
          */
         TiffReader(const byte*          pData,
                    uint32_t             size,
                    TiffComponent*       pRoot,
-                   TiffRwState          state);
+                   TiffRwState          state,
+                   BasicIo*             pIo =nullptr,
+                   FileRanges*          pRanges =nullptr);
 
         //! Virtual destructor
         ~TiffReader() override = default;
@@ -675,6 +771,12 @@ namespace Exiv2 {
         bool circularReference(const byte* start, IfdId group);
         //! Return the next idx sequence number for \em group
         int nextIdx(IfdId group);
+        //! Make \em size bytes of the data buffer at \em p available, see BasicIo::populateMap()
+        void populateMap(const byte* p, size_t size);
+        //! Announce the values outside of the \em n entries of the IFD at \em p to the IO
+        void prefetchValues(const byte* p, uint16_t n);
+        //! Make the data area of \em object available, if it is copied by setStrips()
+        void populateDataArea(TiffDataEntryBase* object, const Value* pSize);
 
         /*!
           @brief Read deferred components.
@@ -713,6 +815,8 @@ namespace Exiv2 {
         IdxSeq               idxSeq_;     //!< Sequences for group, used for the entry's idx
         PostList             postList_;   //!< List of components with deferred reading
         bool                 postProc_;   //!< True in postProcessList()
+        BasicIo*             pIo_;        //!< IO of a sparsely mapped data buffer, or 0
+        FileRanges*          pRanges_;    //!< Ranges of the data buffer which are read, or 0
     }; // class TiffReader
 
 }}                                      // namespace Internal, Exiv2
@@ -313,6 +313,21 @@ namespace Exiv2 {
         return {buf.c_data(), begin, end};
     }
 
+    void appendDecimal(std::string& buf, int64_t value)
+    {
+        // Large enough for "-9223372036854775808"
+        char str[20];
+        char* const end = str + sizeof(str);
+        char* p = end;
+        uint64_t u = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        do {
+            *--p = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        if (value < 0) *--p = '-';
+        buf.append(p, end);
+    }
+
     std::ostream& operator<<(std::ostream& os, const Rational& r)
     {
         return os << r.first << "/" << r.second;
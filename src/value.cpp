@@ -29,6 +29,7 @@
 // + standard includes
 #include <iostream>
 #include <iomanip>
+#include <locale>
 #include <sstream>
 #include <cassert>
 #include <cstring>
@@ -37,6 +38,88 @@
 #include <cstdio>
 #include <cstdlib>
 #include <ctype.h>
+#include <typeinfo>
+
+// *****************************************************************************
+// local declarations
+namespace {
+    using namespace Exiv2;
+
+    //! Append an integer component of a value to \em buf
+    void appendComponent(std::string& buf, int64_t component)
+    {
+        appendDecimal(buf, component);
+    }
+
+    //! Append a rational component of a value to \em buf
+    template<typename T>
+    void appendComponent(std::string& buf, const std::pair<T, T>& component)
+    {
+        appendDecimal(buf, component.first);
+        buf += '/';
+        appendDecimal(buf, component.second);
+    }
+
+    //! Append the components of \em value to \em buf, separated by spaces
+    template<typename T>
+    void appendComponents(std::string& buf, const ValueType<T>& value)
+    {
+        for (auto i = value.value_.begin(); i != value.value_.end(); ++i) {
+            if (i != value.value_.begin()) buf += ' ';
+            appendComponent(buf, *i);
+        }
+    }
+
+    /*!
+      @brief Append \em value to \em buf without an output stream, with the
+             same result as its write() function for the classic locale.
+             Only the classes of the library with such a formatter are
+             handled. Subclasses may override write(), they are not.
+
+      @return true if the value was appended, else false.
+     */
+    bool appendTo(std::string& buf, const Value& value)
+    {
+        const std::type_info& type = typeid(value);
+        if (type == typeid(UShortValue)) {
+            appendComponents(buf, static_cast<const UShortValue&>(value));
+        }
+        else if (type == typeid(ULongValue)) {
+            appendComponents(buf, static_cast<const ULongValue&>(value));
+        }
+        else if (type == typeid(ShortValue)) {
+            appendComponents(buf, static_cast<const ShortValue&>(value));
+        }
+        else if (type == typeid(LongValue)) {
+            appendComponents(buf, static_cast<const LongValue&>(value));
+        }
+        else if (type == typeid(URationalValue)) {
+            appendComponents(buf, static_cast<const URationalValue&>(value));
+        }
+        else if (type == typeid(RationalValue)) {
+            appendComponents(buf, static_cast<const RationalValue&>(value));
+        }
+        else if (type == typeid(DataValue)) {
+            buf.reserve(value.count() * 4);
+            for (long i = 0; i < value.count(); ++i) {
+                if (i > 0) buf += ' ';
+                appendDecimal(buf, value.toLong(i));
+            }
+        }
+        else if (type == typeid(StringValue)) {
+            buf += static_cast<const StringValue&>(value).value_;
+        }
+        else if (type == typeid(AsciiValue)) {
+            // Append only up to the first '\0' (if any)
+            const std::string& str = static_cast<const AsciiValue&>(value).value_;
+            buf.append(str, 0, str.find_first_of('\0'));
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
 
 // *****************************************************************************
 // class member definitions
@@ -124,6 +207,15 @@ namespace Exiv2 {
 
     std::string Value::toString() const
     {
+        // The stream-less formatters produce the same output as write() only
+        // for the classic locale
+        if (std::locale() == std::locale::classic()) {
+            std::string buf;
+            if (appendTo(buf, *this)) {
+                ok_ = true;
+                return buf;
+            }
+        }
         std::ostringstream os;
         write(os);
         ok_ = !os.fail();
@@ -39,6 +39,7 @@
 #include "convert.hpp"
 #include "safe_op.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <string>
@@ -47,6 +48,7 @@
 #include <sstream>
 #include <cassert>
 #include <cstdio>
+#include <vector>
 
 #define CHECK_BIT(var,pos) ((var) & (1<<(pos)))
 
@@ -63,6 +65,63 @@ namespace Exiv2 {
       enforce(!iIo.error(), err);
     }
 
+    namespace {
+        //! Position of a chunk in a WebP file
+        struct WebPChunk {
+            byte     id[4];                     //!< Chunk id
+            uint32_t size;                      //!< Size of the payload, without padding
+            long     offset;                    //!< Offset of the payload in the file
+        };
+
+        //! Compare a chunk id with a tag, see WebPImage::equalsWebPTag()
+        bool equalsTag(const byte* id, const char* str)
+        {
+            for (int i = 0; i < 4; i++)
+                if (toupper(id[i]) != str[i])
+                    return false;
+            return true;
+        }
+
+        //! Read the header of the chunk at the current position of \em iIo, check that it ends before \em end
+        WebPChunk readChunkHeader(BasicIo& iIo, long end)
+        {
+            WebPChunk chunk;
+            byte size_buff[4];
+            readOrThrow(iIo, chunk.id, 4, Exiv2::kerCorruptedMetadata);
+            readOrThrow(iIo, size_buff, 4, Exiv2::kerCorruptedMetadata);
+            chunk.size = Exiv2::getULong(size_buff, littleEndian);
+            chunk.offset = iIo.tell();
+
+            // Check that the payload is within bounds.
+            const long last = std::min(end, static_cast<long>(iIo.size()));
+            enforce(chunk.offset <= last, Exiv2::kerCorruptedMetadata);
+            enforce(chunk.size <= static_cast<unsigned long>(last - chunk.offset), Exiv2::kerCorruptedMetadata);
+            return chunk;
+        }
+
+        //! Seek past the payload of \em chunk and its padding
+        void skipChunk(BasicIo& iIo, const WebPChunk& chunk)
+        {
+            iIo.seek(chunk.offset + static_cast<long>(chunk.size), BasicIo::beg);
+            if (iIo.tell() % 2) iIo.seek(+1, BasicIo::cur); // skip pad
+        }
+
+        /*!
+          @brief Read the headers of the chunks from the current position of
+                 \em iIo to \em end, seeking past the payloads.
+          @return The chunks in the order of the file.
+         */
+        std::vector<WebPChunk> readChunkIndex(BasicIo& iIo, long end)
+        {
+            std::vector<WebPChunk> chunks;
+            while (!iIo.eof() && iIo.tell() < end) {
+                chunks.push_back(readChunkHeader(iIo, end));
+                skipChunk(iIo, chunks.back());
+            }
+            return chunks;
+        }
+    }
+
     WebPImage::WebPImage(BasicIo::UniquePtr io)
     : Image(ImageType::webp, mdNone, std::move(io))
     {
@@ -118,7 +177,7 @@ namespace Exiv2 {
             throw Error(kerDataSourceOpenFailed, io_->path(), strError());
         }
         IoCloser closer(*io_);
-        BasicIo::UniquePtr tempIo(new MemIo);
+        BasicIo::UniquePtr tempIo = Internal::createTempIo(*io_);
         assert (tempIo.get() != 0);
 
         doWriteMetadata(*tempIo); // may throw
@@ -168,7 +227,7 @@ namespace Exiv2 {
             }
         }
 
-        if (xmpData_.count() > 0 && !writeXmpFromPacket()) {
+        if (!writeXmpFromPacket() && xmpData_.count() > 0) {
             XmpParser::encode(xmpPacket_, xmpData_,
                               XmpParser::useCompactFormat |
                               XmpParser::omitAllFormatting);
@@ -176,24 +235,20 @@ namespace Exiv2 {
         has_xmp = !xmpPacket_.empty();
         std::string xmp(xmpPacket_);
 
+        // Index the chunks, the image data is not read but copied
+        enforce(filesize + 8 <= static_cast<uint64_t>(std::numeric_limits<long>::max()), Exiv2::kerCorruptedMetadata);
+        const std::vector<WebPChunk> chunks = readChunkIndex(*io_, static_cast<long>(filesize + 8));
+
         /* Verify for a VP8X Chunk First before writing in
          case we have any exif or xmp data, also check
          for any chunks with alpha frame/layer set */
-        while (!io_->eof() && static_cast<uint64_t>(io_->tell()) < filesize) {
-            readOrThrow(*io_, chunkId.data(), WEBP_TAG_SIZE, Exiv2::kerCorruptedMetadata);
-            readOrThrow(*io_, size_buff, WEBP_TAG_SIZE, Exiv2::kerCorruptedMetadata);
-            const uint32_t size_u32 = Exiv2::getULong(size_buff, littleEndian);
-
-            // Check that `size_u32` is safe to cast to `long`.
-            enforce(size_u32 <= static_cast<size_t>(std::numeric_limits<unsigned int>::max()),
-                    Exiv2::kerCorruptedMetadata);
-            const long size = static_cast<long>(size_u32);
-            DataBuf payload(size);
+        for (auto&& chunk : chunks) {
+            const long size = static_cast<long>(chunk.size);
+            std::memcpy(chunkId.data(), chunk.id, WEBP_TAG_SIZE);
+            // All the fields which are checked are in the first 12 bytes
+            DataBuf payload(std::min(size, 12L));
+            io_->seek(chunk.offset, BasicIo::beg);
             readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
-            if ( payload.size() % 2 ) {
-              byte c = 0;
-              readOrThrow(*io_, &c, 1, Exiv2::kerCorruptedMetadata);
-            }
 
             /* Chunk with information about features
              used in the file. */
@@ -315,24 +370,16 @@ namespace Exiv2 {
                         has_icc, width, height);
         }
 
-        io_->seek(12, BasicIo::beg);
-        while (!io_->eof() && static_cast<uint64_t>(io_->tell()) < filesize) {
-            readOrThrow(*io_, chunkId.data(), 4, Exiv2::kerCorruptedMetadata);
-            readOrThrow(*io_, size_buff, 4, Exiv2::kerCorruptedMetadata);
-
-            const uint32_t size_u32 = Exiv2::getULong(size_buff, littleEndian);
-
-            // Check that `size_u32` is safe to cast to `long`.
-            enforce(size_u32 <= static_cast<size_t>(std::numeric_limits<unsigned int>::max()),
-                    Exiv2::kerCorruptedMetadata);
-            const long size = static_cast<long>(size_u32);
-
-            DataBuf payload(size);
-            readOrThrow(*io_, payload.data(), size, Exiv2::kerCorruptedMetadata);
-            if ( io_->tell() % 2 ) io_->seek(+1,BasicIo::cur); // skip pad
+        for (auto&& chunk : chunks) {
+            const long size = static_cast<long>(chunk.size);
+            std::memcpy(chunkId.data(), chunk.id, WEBP_TAG_SIZE);
+            ul2Data(size_buff, chunk.size, littleEndian);
+            io_->seek(chunk.offset, BasicIo::beg);
 
             if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_VP8X)) {
                 enforce(size >= 1, Exiv2::kerCorruptedMetadata);
+                DataBuf payload(size);
+                readOrThrow(*io_, payload.data(), size, Exiv2::kerCorruptedMetadata);
                 if (has_icc){
                     const uint8_t x = payload.read_uint8(0);
                     payload.write_uint8(0, x | WEBP_VP8X_ICC_BIT);
@@ -389,8 +436,7 @@ namespace Exiv2 {
                     throw Error(kerImageWriteFailed);
                 if (outIo.write(size_buff, WEBP_TAG_SIZE) != WEBP_TAG_SIZE)
                     throw Error(kerImageWriteFailed);
-                if (outIo.write(payload.c_data(), payload.size()) != payload.size())
-                    throw Error(kerImageWriteFailed);
+                copyIo(*io_, outIo, chunk.size);
             }
 
             // Encoder required to pad odd sized data with a null byte
@@ -536,37 +582,24 @@ namespace Exiv2 {
 
     void WebPImage::decodeChunks(long filesize)
     {
-        DataBuf   chunkId(5);
-        byte      size_buff[WEBP_TAG_SIZE];
         bool      has_canvas_data = false;
 
 #ifdef EXIV2_DEBUG_MESSAGES
         std::cout << "Reading metadata" << std::endl;
 #endif
 
-        chunkId.write_uint8(4, '\0');
+        // Only the chunks with metadata and the start of the first chunk
+        // with the canvas size are read, image data is skipped
         while (!io_->eof() && io_->tell() < filesize) {
-            readOrThrow(*io_, chunkId.data(), WEBP_TAG_SIZE, Exiv2::kerCorruptedMetadata);
-            readOrThrow(*io_, size_buff, WEBP_TAG_SIZE, Exiv2::kerCorruptedMetadata);
-
-            const uint32_t size_u32 = Exiv2::getULong(size_buff, littleEndian);
+            const WebPChunk chunk = readChunkHeader(*io_, filesize);
+            const long size = static_cast<long>(chunk.size);
 
-            // Check that `size_u32` is safe to cast to `long`.
-            enforce(static_cast<uint64_t>(size_u32) <= static_cast<unsigned long>(std::numeric_limits<long>::max()),
-                    Exiv2::kerCorruptedMetadata);
-            const long size = static_cast<long>(size_u32);
-
-            // Check that `size` is within bounds.
-            enforce(io_->tell() <= filesize, Exiv2::kerCorruptedMetadata);
-            enforce(size <= (filesize - io_->tell()), Exiv2::kerCorruptedMetadata);
-
-            DataBuf payload(size);
-
-            if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_VP8X) && !has_canvas_data) {
+            if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_VP8X) && !has_canvas_data) {
                 enforce(size >= 10, Exiv2::kerCorruptedMetadata);
 
                 has_canvas_data = true;
                 byte size_buf[WEBP_TAG_SIZE];
+                DataBuf payload(10);
 
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
 
@@ -579,10 +612,11 @@ namespace Exiv2 {
                 memcpy(&size_buf, payload.c_data(7), 3);
                 size_buf[3] = 0;
                 pixelHeight_ = Exiv2::getULong(size_buf, littleEndian) + 1;
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_VP8) && !has_canvas_data) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_VP8) && !has_canvas_data) {
                 enforce(size >= 10, Exiv2::kerCorruptedMetadata);
 
                 has_canvas_data = true;
+                DataBuf payload(10);
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
                 byte size_buf[WEBP_TAG_SIZE];
 
@@ -597,12 +631,13 @@ namespace Exiv2 {
                 size_buf[2] = 0;
                 size_buf[3] = 0;
                 pixelHeight_ = Exiv2::getULong(size_buf, littleEndian) & 0x3fff;
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_VP8L) && !has_canvas_data) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_VP8L) && !has_canvas_data) {
                 enforce(size >= 5, Exiv2::kerCorruptedMetadata);
 
                 has_canvas_data = true;
                 byte size_buf_w[2];
                 byte size_buf_h[3];
+                DataBuf payload(5);
 
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
 
@@ -616,11 +651,12 @@ namespace Exiv2 {
                 size_buf_h[0] = ((size_buf_h[0] >> 6) & 0x3) | ((size_buf_h[1]  & 0x3F) << 0x2);
                 size_buf_h[1] = ((size_buf_h[1] >> 6) & 0x3) | ((size_buf_h[2] & 0xF) << 0x2);
                 pixelHeight_ = Exiv2::getUShort(size_buf_h, littleEndian) + 1;
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_ANMF) && !has_canvas_data) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_ANMF) && !has_canvas_data) {
                 enforce(size >= 12, Exiv2::kerCorruptedMetadata);
 
                 has_canvas_data = true;
                 byte size_buf[WEBP_TAG_SIZE];
+                DataBuf payload(12);
 
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
 
@@ -633,10 +669,12 @@ namespace Exiv2 {
                 memcpy(&size_buf, payload.c_data(9), 3);
                 size_buf[3] = 0;
                 pixelHeight_ = Exiv2::getULong(size_buf, littleEndian) + 1;
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_ICCP)) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_ICCP)) {
+                DataBuf payload(size);
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
                 this->setIccProfile(payload);
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_EXIF)) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_EXIF)) {
+                DataBuf payload(size);
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
 
                 byte  size_buff2[2];
@@ -714,25 +752,19 @@ namespace Exiv2 {
 #endif
                     exifData_.clear();
                 }
-            } else if (equalsWebPTag(chunkId, WEBP_CHUNK_HEADER_XMP)) {
+            } else if (equalsTag(chunk.id, WEBP_CHUNK_HEADER_XMP)) {
+                DataBuf payload(size);
                 readOrThrow(*io_, payload.data(), payload.size(), Exiv2::kerCorruptedMetadata);
                 xmpPacket_.assign(payload.c_str(), payload.size());
-                if (!xmpPacket_.empty() && XmpParser::decode(xmpData_, xmpPacket_)) {
-#ifndef SUPPRESS_WARNINGS
-                    EXV_WARNING << "Failed to decode XMP metadata." << std::endl;
-#endif
-                } else {
+                xmpData_.setPacketDeferred(xmpPacket_);
 #ifdef EXIV2_DEBUG_MESSAGES
-                    std::cout << "Display Hex Dump [size:" << static_cast<unsigned long>(payload.size()) << "]"
-                              << std::endl;
-                    std::cout << Internal::binaryToHex(payload.c_data(), payload.size());
+                std::cout << "Display Hex Dump [size:" << static_cast<unsigned long>(payload.size()) << "]"
+                          << std::endl;
+                std::cout << Internal::binaryToHex(payload.c_data(), payload.size());
 #endif
-                }
-            } else {
-                io_->seek(size, BasicIo::cur);
             }
 
-            if ( io_->tell() % 2 ) io_->seek(+1, BasicIo::cur);
+            skipChunk(*io_, chunk);
         }
     }
 
@@ -775,10 +807,7 @@ namespace Exiv2 {
      @return Returns true if the buffer value is equal to string.
      */
     bool WebPImage::equalsWebPTag(Exiv2::DataBuf& buf, const char* str) {
-        for(int i = 0; i < 4; i++ )
-            if(toupper(buf.read_uint8(i)) != str[i])
-                return false;
-        return true;
+        return equalsTag(buf.c_data(), str);
     }
 
 
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <cassert>
 #include <string>
+#include <thread>
 #include <expat.h>
 
 // Adobe XMP Toolkit
@@ -489,18 +490,21 @@ namespace Exiv2 {
 
     int XmpData::add(const Xmpdatum& xmpDatum)
     {
+        decodeDeferred();
         xmpMetadata_.push_back(xmpDatum);
         return 0;
     }
 
     XmpData::const_iterator XmpData::findKey(const XmpKey& key) const
     {
+        decodeDeferred();
         return std::find_if(xmpMetadata_.begin(), xmpMetadata_.end(),
                             FindXmpdatum(key));
     }
 
     XmpData::iterator XmpData::findKey(const XmpKey& key)
     {
+        decodeDeferred();
         return std::find_if(xmpMetadata_.begin(), xmpMetadata_.end(),
                             FindXmpdatum(key));
     }
@@ -508,20 +512,24 @@ namespace Exiv2 {
     void XmpData::clear()
     {
         xmpMetadata_.clear();
+        state_.value_.store(DecodeState::decoded, std::memory_order_release);
     }
 
     void XmpData::sortByKey()
     {
+        decodeDeferred();
         std::sort(xmpMetadata_.begin(), xmpMetadata_.end(), cmpMetadataByKey);
     }
 
     XmpData::const_iterator XmpData::begin() const
     {
+        decodeDeferred();
         return xmpMetadata_.begin();
     }
 
     XmpData::const_iterator XmpData::end() const
     {
+        decodeDeferred();
         return xmpMetadata_.end();
     }
 
@@ -532,19 +540,89 @@ namespace Exiv2 {
 
     long XmpData::count() const
     {
+        decodeDeferred();
         return static_cast<long>(xmpMetadata_.size());
     }
 
     XmpData::iterator XmpData::begin()
     {
+        decodeDeferred();
         return xmpMetadata_.begin();
     }
 
     XmpData::iterator XmpData::end()
     {
+        decodeDeferred();
         return xmpMetadata_.end();
     }
 
+    XmpData::XmpData(const XmpData& rhs)
+    {
+        *this = rhs;
+    }
+
+    XmpData& XmpData::operator=(const XmpData& rhs)
+    {
+        if (this == &rhs) return *this;
+        // rhs may be decoded by another thread which reads it
+        const bool pending = rhs.lockPending();
+        try {
+            xmpMetadata_ = rhs.xmpMetadata_;
+            xmpPacket_ = rhs.xmpPacket_;
+        }
+        catch (...) {
+            if (pending) rhs.state_.value_.store(DecodeState::pending, std::memory_order_release);
+            throw;
+        }
+        usePacket_ = rhs.usePacket_;
+        const char state = pending ? DecodeState::pending : DecodeState::decoded;
+        state_.value_.store(state, std::memory_order_release);
+        if (pending) rhs.state_.value_.store(DecodeState::pending, std::memory_order_release);
+        return *this;
+    }
+
+    void XmpData::setPacketDeferred(const std::string& xmpPacket)
+    {
+        clear();
+        setPacket(xmpPacket);
+        if (!xmpPacket.empty()) state_.value_.store(DecodeState::pending, std::memory_order_release);
+    }
+
+    bool XmpData::lockPending() const
+    {
+        for (;;) {
+            char state = state_.value_.load(std::memory_order_acquire);
+            if (state == DecodeState::decoded) return false;
+            if (state == DecodeState::pending &&
+                state_.value_.compare_exchange_weak(state, DecodeState::busy, std::memory_order_acquire)) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void XmpData::decodeDeferred() const
+    {
+        if (!lockPending()) return;
+        // Decode into a temporary container, this one may be const
+        XmpData xmpData;
+        int rc = 0;
+        try {
+            rc = XmpParser::decode(xmpData, xmpPacket_);
+        }
+        catch (...) {
+            state_.value_.store(DecodeState::pending, std::memory_order_release);
+            throw;
+        }
+        if (rc) {
+#ifndef SUPPRESS_WARNINGS
+            EXV_WARNING << "Failed to decode XMP metadata.\n";
+#endif
+        }
+        xmpMetadata_.swap(xmpData.xmpMetadata_);
+        state_.value_.store(DecodeState::decoded, std::memory_order_release);
+    }
+
     XmpData::iterator XmpData::erase(XmpData::iterator pos) {
         return xmpMetadata_.erase(pos);
     }
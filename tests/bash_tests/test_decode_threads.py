@@ -0,0 +1,38 @@
+# -*- coding: utf-8 -*-
+
+from system_tests import CaseMeta, path
+
+
+class DecodeThreads(metaclass=CaseMeta):
+    """
+    Decode the directories of a TIFF composite in parallel, the metadata
+    and the warnings are the same as when they are decoded one after the
+    other. Each command runs with 1 decode thread and then with 4, for a
+    DNG with two SubIFDs and for a large Sony makernote.
+    """
+
+    env = {"EXIV2_DECODE_THREADS": "1"}
+
+    files = [path("$data_path/IMG_1361.dng"), path("$data_path/exiv2-SonyILCE-7SM3.exv")]
+    commands = ["$exiv2 " + option + " " + filename
+                for filename in files for option in ["-pa", "-pv"] for _ in range(2)]
+    stdout = [""] * len(commands)
+    stderr = [""] * len(commands)
+    retval = [0] * len(commands)
+
+    def post_command_hook(self, i, command):
+        # the next command runs with the other number of threads
+        self.env = {"EXIV2_DECODE_THREADS": "4" if i % 2 == 0 else "1"}
+
+    def compare_stdout(self, i, command, got_stdout, expected_stdout):
+        if i % 2 == 0:
+            self.assertGreater(len(got_stdout.splitlines()), 100)
+            self.serial_stdout = got_stdout
+        else:
+            self.assertMultiLineEqual(self.serial_stdout, got_stdout)
+
+    def compare_stderr(self, i, command, got_stderr, expected_stderr):
+        if i % 2 == 0:
+            self.serial_stderr = got_stderr
+        else:
+            self.assertMultiLineEqual(self.serial_stderr, got_stderr)
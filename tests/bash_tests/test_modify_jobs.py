@@ -0,0 +1,63 @@
+# -*- coding: utf-8 -*-
+
+from system_tests import CaseMeta, CopyTmpFiles, path
+
+
+@CopyTmpFiles("$data_path/exiv2-empty.jpg", "$data_path/exiv2-bug1044.tif",
+              "$data_path/imagemagick.png", "$data_path/exiv2-photoshop.psd")
+class ModifyJobs(metaclass=CaseMeta):
+    """
+    Modify several files in parallel with -j
+    """
+
+    names = ["exiv2-empty.jpg", "exiv2-bug1044.tif", "imagemagick.png", "exiv2-photoshop.psd"]
+    files = " ".join(path("$tmp_path/" + name) for name in names)
+
+    commands = [
+        """$exiv2 -j 3 -M"set Exif.Image.Artist Me" -M"set Iptc.Application2.Caption Cap" -M"set Xmp.dc.title Hello" $files""",
+    ] + [
+        "$exiv2 -Pv -K Exif.Image.Artist -K Iptc.Application2.Caption -K Xmp.dc.title " + path("$tmp_path/" + name)
+        for name in names
+    ] + [
+        # namespaces are registered for all files, these are modified one after the other
+        """$exiv2 -j 2 -M"reg ns1 http://ns1/" -M"set Xmp.ns1.x y" $files""",
+    ] + [
+        "$exiv2 -Pv -K Xmp.ns1.x " + path("$tmp_path/" + name)
+        for name in names
+    ] + [
+        """$exiv2 -j x -M"set Exif.Image.Artist Me" $files""",
+    ]
+    # the makernote is written without the invalid directory
+    nikonError = "Error: Directory NikonPreview with 512 entries considered invalid; not read.\n"
+    usage = """Usage: exiv2 [ option [ arg ] ]+ [ action ] file ...
+
+Image metadata manipulation tool.
+"""
+    stdout = [""] + ["Me\nCap\nlang=\"x-default\" Hello\n"] * 4 + [""] + ["y\n"] * 4 + [usage]
+    stderr = [nikonError] + [""] * 9 + ["exiv2: Error parsing -j option argument `x'\n"]
+    retval = [0] * 10 + [1]
+
+
+@CopyTmpFiles("$data_path/exiv2-empty.jpg", "$data_path/exiv2-bug1044.tif",
+              "$data_path/imagemagick.png", "$data_path/exiv2-photoshop.psd")
+class ModifyJobsVerbose(metaclass=CaseMeta):
+    """
+    The verbose messages of each file modified in parallel are written
+    together, in the order in which the files are done
+    """
+
+    names = ModifyJobs.names
+    files = ModifyJobs.files
+
+    commands = ["""$exiv2 -v -j 4 -M"set Exif.Image.Artist Me" -M"set Xmp.dc.title Hello" $files"""]
+    stdout = ["".join(
+        "File {}/4: {}\nSet Exif.Image.Artist \"Me\" (Ascii)\nSet Xmp.dc.title \"Hello\" (LangAlt)\n".format(
+            i + 1, path("$tmp_path/" + name))
+        for i, name in enumerate(names))]
+    stderr = [ModifyJobs.nikonError]
+    retval = [0]
+
+    def compare_stdout(self, i, command, got_stdout, expected_stdout):
+        def files(stdout):
+            return sorted(stdout.strip().replace("\nFile ", "\n\nFile ").split("\n\n"))
+        self.assertEqual(files(got_stdout), files(expected_stdout))
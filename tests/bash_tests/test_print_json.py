@@ -0,0 +1,104 @@
+# -*- coding: utf-8 -*-
+
+from system_tests import CaseMeta, CopyTmpFiles, path
+
+
+@CopyTmpFiles("$data_path/exiv2-empty.jpg")
+class PrintJson(metaclass=CaseMeta):
+    """
+    Print Exif, IPTC and XMP metadata with -P json and -P ndjson, the
+    objects for several files are the elements of an array with -P json
+    """
+
+    filename = path("$tmp_path/exiv2-empty.jpg")
+
+    commands = [
+        """$exiv2 -M"set Exif.Image.Make Canon" -M"set Exif.Image.BitsPerSample 8 8 8" -M"set Exif.Photo.FNumber 28/10" -M"set Iptc.Application2.Caption \\"Hello\\" world" -M"set Xmp.dc.subject one" -M"set Xmp.dc.title lang=de-DE Titel" -M"set Xmp.xmpMM.History XmpText type=Seq" -M"set Xmp.xmpMM.History[1]/stEvt:action saved" $filename""",
+        "$exiv2 -P json $filename",
+        "$exiv2 -P ndjson $filename",
+        "$exiv2 -P ndjson -K Exif.Image.Make $filename $filename",
+        "$exiv2 -P json -K Exif.Image.Make $filename $filename",
+        "$exiv2 -P json -K Exif.Image.Make $filename $tmp_path/missing.jpg",
+    ]
+    stdout = [
+        "",
+        """{
+    "Exif": {
+        "Image": {
+            "BitsPerSample": [8, 8, 8],
+            "Make": "Canon",
+            "ExifTag": 62
+        },
+        "Photo": {
+            "FNumber": [28, 10]
+        }
+    },
+    "Iptc": {
+        "Application2": {
+            "Caption": "\\"Hello\\" world"
+        }
+    },
+    "Xmp": {
+        "dc": {
+            "subject": ["one"],
+            "title": {
+                "lang": {
+                    "de-DE": "Titel"
+                }
+            }
+        },
+        "xmpMM": {
+            "History": [
+                {
+                    "stEvt": {
+                        "action": "saved"
+                    }
+                }
+            ]
+        },
+        "xmlns": {
+            "dc": "http://purl.org/dc/elements/1.1/",
+            "stEvt": "http://ns.adobe.com/xap/1.0/sType/ResourceEvent#",
+            "xmpMM": "http://ns.adobe.com/xap/1.0/mm/"
+        }
+    }
+}
+""",
+        """{"Exif":{"Image":{"BitsPerSample":[8,8,8],"Make":"Canon","ExifTag":62},"Photo":{"FNumber":[28,10]}},"Iptc":{"Application2":{"Caption":"\\"Hello\\" world"}},"Xmp":{"dc":{"subject":["one"],"title":{"lang":{"de-DE":"Titel"}}},"xmpMM":{"History":[{"stEvt":{"action":"saved"}}]},"xmlns":{"dc":"http://purl.org/dc/elements/1.1/","stEvt":"http://ns.adobe.com/xap/1.0/sType/ResourceEvent#","xmpMM":"http://ns.adobe.com/xap/1.0/mm/"}}}
+""",
+        """{"path":"$filename","Exif":{"Image":{"Make":"Canon"}}}
+{"path":"$filename","Exif":{"Image":{"Make":"Canon"}}}
+""",
+        """[
+    {
+        "path": "$filename",
+        "Exif": {
+            "Image": {
+                "Make": "Canon"
+            }
+        }
+    },
+    {
+        "path": "$filename",
+        "Exif": {
+            "Image": {
+                "Make": "Canon"
+            }
+        }
+    }
+]
+""",
+        """[
+    {
+        "path": "$filename",
+        "Exif": {
+            "Image": {
+                "Make": "Canon"
+            }
+        }
+    }
+]
+""",
+    ]
+    stderr = [""] * 5 + ["$tmp_path/missing.jpg: Failed to open the file\n"]
+    retval = [0] * 5 + [255]
@@ -0,0 +1,267 @@
+# -*- coding: utf-8 -*-
+
+import base64
+import os
+import shutil
+import socket
+import threading
+import urllib.parse
+from http import server
+
+import system_tests
+from system_tests import CaseMeta, path
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(('127.0.0.1', 0))
+        return s.getsockname()[1]
+
+
+class RangeRequestHandler(server.BaseHTTPRequestHandler):
+    """
+    HTTP/1.1 server with keep-alive, byte ranges and an ETag, counts
+    connections and requests and records the ranges requested.
+
+    A POST to /exiv2.php replaces the bytes [from, to) of the file with
+    the data posted, like the server script of RemoteIo::write. Unless
+    range_writes is set, only writes of the whole file are accepted. If
+    close_after_post is set, the connection is closed after a POST is
+    handled, without a response.
+    """
+    protocol_version = 'HTTP/1.1'
+    root = None
+    range_writes = True
+    close_after_post = False
+    connections = 0
+    requests = 0
+    ranges = []
+    posts = []
+
+    def setup(self):
+        super().setup()
+        RangeRequestHandler.connections += 1
+
+    def log_message(self, format, *args):
+        pass
+
+    def do_HEAD(self):
+        self.send(head=True)
+
+    def do_GET(self):
+        self.send(head=False)
+
+    def do_POST(self):
+        length = int(self.headers.get('Content-Length'))
+        form = urllib.parse.parse_qs(self.rfile.read(length).decode())
+        file = os.path.join(self.root, form['path'][0].lstrip('/'))
+        first, last = int(form['from'][0]), int(form['to'][0])
+        data = base64.b64decode(form['data'][0])
+        RangeRequestHandler.posts.append((first, last, len(data)))
+        with open(file, 'rb') as f:
+            content = f.read()
+        status = 200
+        if self.range_writes or (first == 0 and last == len(content)):
+            with open(file, 'wb') as f:
+                f.write(content[:first] + data + content[last:])
+        else:
+            status = 501
+        if self.close_after_post:
+            self.close_connection = True
+            return
+        self.send_response(status)
+        self.send_header('Content-Length', '0')
+        self.end_headers()
+
+    def send(self, head):
+        RangeRequestHandler.requests += 1
+        file = os.path.join(self.root, self.path.lstrip('/'))
+        with open(file, 'rb') as f:
+            data = f.read()
+        status = 200
+        ranges = self.headers.get('Range')
+        if ranges:
+            RangeRequestHandler.ranges.append(ranges)
+            first, last = ranges.split('=')[1].split('-')
+            data = data[int(first):int(last) + 1]
+            status = 206
+        self.send_response(status)
+        self.send_header('Content-Length', str(len(data)))
+        self.send_header('ETag', '"{}"'.format(os.path.getmtime(file)))
+        self.end_headers()
+        if not head:
+            self.wfile.write(data)
+
+
+class HttpKeepAlive(metaclass=CaseMeta):
+    """
+    Reading a remote file over HTTP/1.1 uses one persistent connection
+    for the HEAD and all range requests. The metadata segments at the
+    start of the JPEG come with the first range request.
+    """
+
+    port = free_port()
+    url = 'http://127.0.0.1:{}/Reagan.jpg'.format(port)
+    commands = ["$exiv2 -pa -g Image.Make -g Image.Model -g DateTimeOriginal $url"]
+    stdout = ["""Exif.Image.Make                              Ascii      18  NIKON CORPORATION
+Exif.Image.Model                             Ascii      10  NIKON D1X
+Exif.Photo.DateTimeOriginal                  Ascii      20  2004:06:21 23:37:53
+"""]
+    stderr = [""]
+    retval = [0]
+
+    def setUp(self):
+        RangeRequestHandler.root = system_tests.BT.Config.data_dir
+        RangeRequestHandler.range_writes = True
+        RangeRequestHandler.close_after_post = False
+        RangeRequestHandler.connections = 0
+        RangeRequestHandler.requests = 0
+        RangeRequestHandler.ranges = []
+        RangeRequestHandler.posts = []
+        self.server = server.ThreadingHTTPServer(('127.0.0.1', self.port), RangeRequestHandler)
+        self.thread = threading.Thread(target=self.server.serve_forever)
+        self.thread.start()
+
+    def tearDown(self):
+        self.server.shutdown()
+        self.server.server_close()
+        self.thread.join()
+
+    def post_tests_hook(self):
+        self.assertEqual(RangeRequestHandler.requests, 2)
+        self.assertEqual(RangeRequestHandler.connections, 1)
+
+
+class RemoteBlockCache(HttpKeepAlive):
+    """
+    With EXIV2_REMOTE_CACHE, the blocks read from a remote file are kept in
+    a cache file and not requested again when the file is read a second time
+    """
+
+    commands = [HttpKeepAlive.commands[0]] * 2
+    stdout = HttpKeepAlive.stdout * 2
+    stderr = [""] * 2
+    retval = [0] * 2
+
+    def setUp(self):
+        self.cache = os.path.join(system_tests.BT.Config.tmp_dir, 'remote_cache')
+        os.makedirs(self.cache, exist_ok=True)
+        self.env = {'EXIV2_REMOTE_CACHE': self.cache}
+        super().setUp()
+
+    def tearDown(self):
+        super().tearDown()
+        shutil.rmtree(self.cache)
+
+    def post_tests_hook(self):
+        self.assertGreater(len(RangeRequestHandler.ranges), 0)
+        self.assertEqual(len(RangeRequestHandler.ranges), len(set(RangeRequestHandler.ranges)))
+
+
+class RemoteWrite(HttpKeepAlive):
+    """
+    Modifying a remote file posts only the changed bytes to the server
+    script, the result is the same as for a local file
+    """
+
+    url = 'http://127.0.0.1:{}/remote_write.jpg'.format(HttpKeepAlive.port)
+    local = path("$tmp_path/remote_write_local.jpg")
+    commands = [
+        """$exiv2 -M"set Exif.Image.Artist Exiv2" $url""",
+        """$exiv2 -M"set Exif.Image.Artist Exiv2" $local""",
+    ]
+    stdout = [""] * 2
+    stderr = [""] * 2
+    retval = [0] * 2
+
+    def setUp(self):
+        super().setUp()
+        tmp = system_tests.BT.Config.tmp_dir
+        RangeRequestHandler.root = tmp
+        self.remote = os.path.join(tmp, 'remote_write.jpg')
+        for file in [self.remote, self.local]:
+            shutil.copy(os.path.join(system_tests.BT.Config.data_dir, 'Reagan.jpg'), file)
+        self.env = {'EXIV2_HTTP_POST': '/exiv2.php'}
+
+    def tearDown(self):
+        super().tearDown()
+        for file in [self.remote, self.local]:
+            os.remove(file)
+
+    def post_tests_hook(self):
+        with open(self.remote, 'rb') as remote, open(self.local, 'rb') as local:
+            self.assertEqual(remote.read(), local.read())
+        self.assertEqual(len(RangeRequestHandler.posts), 1)
+        first, last, length = RangeRequestHandler.posts[0]
+        self.assertGreater(first, 0)
+        self.assertLess(length, os.path.getsize(self.local) // 2)
+
+
+class RemoteWriteFallback(RemoteWrite):
+    """
+    If the server script does not accept writes of a part of the file,
+    the whole file is posted
+    """
+
+    commands = RemoteWrite.commands
+    stdout = RemoteWrite.stdout
+    stderr = RemoteWrite.stderr
+    retval = RemoteWrite.retval
+
+    def setUp(self):
+        super().setUp()
+        RangeRequestHandler.range_writes = False
+
+    def post_tests_hook(self):
+        with open(self.remote, 'rb') as remote, open(self.local, 'rb') as local:
+            self.assertEqual(remote.read(), local.read())
+        self.assertEqual(len(RangeRequestHandler.posts), 2)
+        self.assertEqual(RangeRequestHandler.posts[1][:2], (0, os.path.getsize(os.path.join(system_tests.BT.Config.data_dir, 'Reagan.jpg'))))
+
+
+class RemoteWriteNotRetried(RemoteWrite):
+    """
+    A POST is sent on a new connection and not sent again if the server
+    closes the connection after handling it, nor is the whole file posted
+    instead, since the remote file may have changed
+    """
+
+    url = RemoteWrite.url
+    commands = [RemoteWrite.commands[0]]
+    stdout = [""]
+    stderr = ["""error - no response to POST request from server = 127.0.0.1, not sent again
+Exiv2 exception in modify action for file $url:
+/remote_write.jpg: Transfer failed: no response from the server
+"""]
+    retval = [1]
+
+    def setUp(self):
+        super().setUp()
+        RangeRequestHandler.close_after_post = True
+
+    def post_tests_hook(self):
+        self.assertEqual(len(RangeRequestHandler.posts), 1)
+        self.assertEqual(RangeRequestHandler.connections, 2)
+
+
+class RemoteTiffSparse(HttpKeepAlive):
+    """
+    Reading the metadata of a remote TIFF file only requests the parts of
+    the file which are parsed, not the image data
+    """
+
+    url = 'http://127.0.0.1:{}/exiv2-bug1044.tif'.format(HttpKeepAlive.port)
+    commands = ["$exiv2 -pa -K Exif.Image.ImageWidth -K Exif.Image.Compression $url"]
+    stdout = ["""Exif.Image.ImageWidth                        Short       1  1392
+Exif.Image.Compression                       Short       1  LZW
+"""]
+    stderr = [""]
+    retval = [0]
+
+    def post_tests_hook(self):
+        requested = 0
+        for ranges in RangeRequestHandler.ranges:
+            first, last = ranges.split('=')[1].split('-')
+            requested += int(last) - int(first) + 1
+        size = os.path.getsize(os.path.join(system_tests.BT.Config.data_dir, 'exiv2-bug1044.tif'))
+        self.assertLess(requested, size // 10)
@@ -8,7 +8,8 @@ class TestCvePoC(metaclass=system_tests.CaseMeta):
     url = "https://github.com/Exiv2/exiv2/issues/138"
 
     filename = "$data_path/007-heap-buffer-over"
-    commands = ["$exiv2 $filename"]
+    # -px decodes the XMP packet, which is done only when it is accessed
+    commands = ["$exiv2 $filename", "$exiv2 -px $filename"]
     stdout = [
         """File name       : $filename
 File size       : 331696 Bytes
@@ -35,15 +36,21 @@ White balance   :
 Copyright       : 
 Exif comment    : 
 
-"""
+""",
+        ""
     ]
     stderr = [
         """Error: Offset of directory Image, entry 0x0100 is out of bounds: Offset = 0x30303030; truncating the entry
 Warning: Directory Image, entry 0x0111: Strip 17 is outside of the data area; ignored.
 Error: Directory Photo with 8224 entries considered invalid; not read.
 Warning: Removing 913 characters from the beginning of the XMP packet
+""",
+        """Error: Offset of directory Image, entry 0x0100 is out of bounds: Offset = 0x30303030; truncating the entry
+Warning: Directory Image, entry 0x0111: Strip 17 is outside of the data area; ignored.
+Error: Directory Photo with 8224 entries considered invalid; not read.
+Warning: Removing 913 characters from the beginning of the XMP packet
 Error: XMP Toolkit error 201: Error in XMLValidator
 Warning: Failed to decode XMP metadata.
 """
     ]
-    retval = [0]
+    retval = [0] * 2
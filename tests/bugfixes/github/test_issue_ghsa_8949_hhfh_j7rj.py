@@ -12,10 +12,12 @@ class Jp2ImageEncodeJp2HeaderOutOfBoundsRead(metaclass=CaseMeta):
 
     filename1 = path("$tmp_path/issue_ghsa_8949_hhfh_j7rj_poc.jp2")
     filename2 = path("$tmp_path/issue_ghsa_8949_hhfh_j7rj_poc.exv")
-    commands = ["$exiv2 in $filename1"]
-    stdout = [""]
+    # The XMP packet is copied as it is, -px decodes it
+    commands = ["$exiv2 in $filename1", "$exiv2 -px $filename1"]
+    stdout = [""] * 2
     stderr = [
-"""Error: XMP Toolkit error 201: Error in XMLValidator
+        "",
+        """Error: XMP Toolkit error 201: Error in XMLValidator
 Warning: Failed to decode XMP metadata.
 """]
-    retval = [0]
+    retval = [0] * 2
@@ -0,0 +1,40 @@
+# -*- coding: utf-8 -*-
+import sys
+import time
+import system_tests
+
+# number of times the lens is looked up in a single exiv2 run
+REPEAT = 500
+
+
+@system_tests.CopyTmpFiles("$data_path/template.exv")
+class CanonLensTypeTiming(metaclass=system_tests.CaseMeta):
+    """
+    Timing harness for the lens lookup: print the Canon lens type of the same
+    file many times in a single exiv2 run and report how long that took.
+    """
+
+    filename = system_tests.path("$tmp_path/template.exv")
+
+    commands = [
+        '$exiv2 -M"set Exif.CanonCs.LensType 1" -M"set Exif.CanonCs.Lens 50 50 1" -M"set Exif.CanonCs.MaxAperture 52" $filename',
+        "$exiv2 -pt -K Exif.CanonCs.LensType " + " ".join(["$filename"] * REPEAT),
+    ]
+    stderr = [""] * 2
+    stdout = [
+        "",
+        "$filename  Exif.CanonCs.LensType                        Short       1  Canon EF 50mm f/1.8\n" * REPEAT,
+    ]
+    retval = [0] * 2
+
+    def post_command_hook(self, i, command):
+        # the lookups run in the 2nd command
+        if i == 0:
+            self.start = time.perf_counter()
+
+    def post_tests_hook(self):
+        elapsed = time.perf_counter() - self.start
+        print(
+            f"\n{REPEAT} Canon lens lookups: {elapsed * 1000:.1f} ms ({elapsed * 1e6 / REPEAT:.1f} us per file)",
+            file=sys.stderr,
+        )
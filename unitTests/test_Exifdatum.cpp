@@ -0,0 +1,98 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <exiv2/exiv2.hpp>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace Exiv2;
+
+namespace {
+    //! Return the interpreted value written to a new stream
+    std::string written(const Exifdatum& md, const ExifData* pMetadata)
+    {
+        std::ostringstream os;
+        md.write(os, pMetadata);
+        return os.str();
+    }
+
+    //! A value which writes and changes the iword() and exception mask of the stream
+    class StreamStateValue : public ULongValue {
+    public:
+        std::ostream& write(std::ostream& os) const override
+        {
+            os << "iword " << os.iword(index()) << " exceptions " << os.exceptions();
+            os.iword(index()) = 1;
+            os.exceptions(std::ios::badbit);
+            return os;
+        }
+
+        static int index()
+        {
+            static const int index = std::ios_base::xalloc();
+            return index;
+        }
+
+    private:
+        ULongValue* clone_() const override
+        {
+            return new StreamStateValue(*this);
+        }
+    };
+}  // namespace
+
+TEST(AnExifdatum, printsLikeANewStreamAfterOtherPrintFunctions)
+{
+    ExifData exifData;
+    exifData["Exif.Photo.ExposureTime"] = URational(1, 250);
+    exifData["Exif.Photo.FNumber"] = URational(28, 10);
+    exifData["Exif.Photo.FocalLength"] = URational(1234, 100);
+    exifData["Exif.Image.XResolution"] = URational(72, 1);
+    exifData["Exif.Photo.ExposureBiasValue"] = Rational(-2, 3);
+    exifData["Exif.Photo.Flash"] = uint16_t(0x19);
+    exifData["Exif.Image.Artist"] = "Exiv2";
+
+    for (int i = 0; i < 2; ++i) {
+        for (auto&& md : exifData) {
+            ASSERT_EQ(written(md, &exifData), md.print(&exifData)) << md.key();
+        }
+    }
+}
+
+TEST(AnExifdatum, printsWithTheStreamStateOfANewStream)
+{
+    Exifdatum md(ExifKey("Exif.Image.0xfedc"), nullptr);
+    StreamStateValue value;
+    value.read("1");
+    md.setValue(&value);
+
+    ASSERT_EQ("iword 0 exceptions 0", md.print());
+    ASSERT_EQ("iword 0 exceptions 0", md.print());
+}
+
+TEST(AValue, isConvertedToAStringWithTheWriteFunctionOfASubclass)
+{
+    StreamStateValue value;
+    value.read("1");
+    const Value& base = value;
+    ASSERT_EQ("iword 0 exceptions 0", base.toString());
+}
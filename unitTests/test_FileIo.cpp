@@ -20,12 +20,26 @@
 
 #include "basicio.hpp"
 #include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+
 using namespace Exiv2;
 
 namespace
 {
     const std::string testData(TESTDATA_PATH);
     const std::string imagePath(testData + "/DSC_3079.jpg");
+    const std::string copyPath("test_FileIo_copy.jpg");
+
+    DataBuf readFile(BasicIo& io)
+    {
+        DataBuf buf(static_cast<long>(io.size()));
+        io.open();
+        io.read(buf.data(), buf.size());
+        io.close();
+        return buf;
+    }
 }  // namespace
 
 TEST(AFileIO, canBeInstantiatedWithFilePath)
@@ -90,3 +104,146 @@ TEST(AFileIO, canSeekBeyondEOF)
     ASSERT_FALSE(file.error());
     ASSERT_FALSE(file.eof());
 }
+
+TEST(AFileIO, writesTheRestOfAnotherFile)
+{
+    FileIo src(imagePath);
+    src.open();
+    src.seek(1000, BasicIo::beg);
+    {
+        FileIo dest(copyPath);
+        ASSERT_EQ(0, dest.open("w+b"));
+        ASSERT_EQ(2, dest.write(reinterpret_cast<const byte*>("ab"), 2));
+        ASSERT_EQ(117685L, dest.write(src));
+        ASSERT_EQ(118685L, src.tell());
+        ASSERT_EQ(117687L, dest.tell());
+        ASSERT_EQ(1, dest.write(reinterpret_cast<const byte*>("c"), 1));
+    }
+    src.close();
+
+    FileIo dest(copyPath);
+    DataBuf expected = readFile(src);
+    DataBuf actual = readFile(dest);
+    ASSERT_EQ(117688L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), "ab", 2));
+    ASSERT_EQ(0, memcmp(actual.c_data(2), expected.c_data(1000), 117685));
+    ASSERT_EQ('c', actual.c_data()[117687]);
+    std::remove(copyPath.c_str());
+}
+
+TEST(AFileIO, writesTheRestOfAMemIo)
+{
+    FileIo src(imagePath);
+    DataBuf expected = readFile(src);
+    MemIo memIo(expected.c_data(), expected.size());
+    memIo.seek(100, BasicIo::beg);
+    {
+        FileIo dest(copyPath);
+        ASSERT_EQ(0, dest.open("w+b"));
+        ASSERT_EQ(118585L, dest.write(memIo));
+        ASSERT_EQ(118685L, memIo.tell());
+        ASSERT_EQ(0L, dest.write(memIo));
+    }
+
+    FileIo dest(copyPath);
+    DataBuf actual = readFile(dest);
+    ASSERT_EQ(118585L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), expected.c_data(100), 118585));
+    std::remove(copyPath.c_str());
+}
+
+TEST(AFileIO, writesAPartOfAnotherFileOrMemIo)
+{
+    FileIo src(imagePath);
+    DataBuf expected = readFile(src);
+    MemIo memIo(expected.c_data(), expected.size());
+    memIo.seek(2000, BasicIo::beg);
+    src.open();
+    src.seek(1000, BasicIo::beg);
+    {
+        FileIo dest(copyPath);
+        ASSERT_EQ(0, dest.open("w+b"));
+        ASSERT_EQ(500L, dest.write(src, 500));
+        ASSERT_EQ(1500L, src.tell());
+        ASSERT_EQ(300L, dest.write(memIo, 300));
+        ASSERT_EQ(2300L, memIo.tell());
+        src.seek(-10, BasicIo::end);
+        ASSERT_EQ(10L, dest.write(src, 100));
+    }
+    src.close();
+
+    FileIo dest(copyPath);
+    DataBuf actual = readFile(dest);
+    ASSERT_EQ(810L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), expected.c_data(1000), 500));
+    ASSERT_EQ(0, memcmp(actual.c_data(500), expected.c_data(2000), 300));
+    ASSERT_EQ(0, memcmp(actual.c_data(800), expected.c_data(118675), 10));
+    std::remove(copyPath.c_str());
+}
+
+TEST(AFileIO, replacesTheFileAtomicallyInAtomicWriteMode)
+{
+    {
+        FileIo file(copyPath);
+        ASSERT_EQ(0, file.open("wb"));
+        ASSERT_EQ(3, file.write(reinterpret_cast<const byte*>("old"), 3));
+    }
+    FileIo file(copyPath);
+    file.setAtomicWrite(true);
+    if (!file.atomicWrite()) return; // not available on this platform
+    MemIo memIo;
+    memIo.write(reinterpret_cast<const byte*>("new!"), 4);
+    file.transfer(memIo);
+
+    DataBuf actual = readFile(file);
+    ASSERT_EQ(4L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), "new!", 4));
+    std::remove(copyPath.c_str());
+}
+
+TEST(AWriteBatch, replacesTheFilesOnCommit)
+{
+    {
+        FileIo file(copyPath);
+        ASSERT_EQ(0, file.open("wb"));
+        ASSERT_EQ(3, file.write(reinterpret_cast<const byte*>("old"), 3));
+    }
+    FileIo file(copyPath);
+    file.setAtomicWrite(true);
+    if (!file.atomicWrite()) return; // not available on this platform
+    file.setAtomicWrite(false);
+    {
+        WriteBatch batch;
+        MemIo memIo;
+        memIo.write(reinterpret_cast<const byte*>("new!"), 4);
+        file.transfer(memIo);
+        ASSERT_EQ(1U, batch.size());
+        ASSERT_EQ(3L, readFile(file).size());
+        batch.commit();
+        ASSERT_EQ(0U, batch.size());
+    }
+    DataBuf actual = readFile(file);
+    ASSERT_EQ(4L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), "new!", 4));
+    std::remove(copyPath.c_str());
+}
+
+TEST(AWriteBatch, discardsTheChangesWhichAreNotCommitted)
+{
+    {
+        FileIo file(copyPath);
+        ASSERT_EQ(0, file.open("wb"));
+        ASSERT_EQ(3, file.write(reinterpret_cast<const byte*>("old"), 3));
+    }
+    FileIo file(copyPath);
+    {
+        WriteBatch batch;
+        MemIo memIo;
+        memIo.write(reinterpret_cast<const byte*>("new!"), 4);
+        file.transfer(memIo);
+    }
+    DataBuf actual = readFile(file);
+    ASSERT_EQ(3L, actual.size());
+    ASSERT_EQ(0, memcmp(actual.c_data(), "old", 3));
+    std::remove(copyPath.c_str());
+}
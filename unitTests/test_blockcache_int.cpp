@@ -0,0 +1,119 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "blockcache_int.hpp"
+#include "config.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace Exiv2;
+using Exiv2::Internal::BlockCache;
+
+namespace {
+    const std::string cacheDir(".");
+    const std::string cacheFile("." EXV_SEPARATOR_STR "exiv2-16.cache");
+}
+
+TEST(BlockCache, returnsTheBlocksWhichWerePut)
+{
+    std::remove(cacheFile.c_str());
+    BlockCache cache(cacheDir, 16, 1024);
+    if (!cache.good()) return; // not available on this platform
+    const uint64_t file = BlockCache::fileKey("http://host/file.jpg", "\"etag\"", 100);
+    const byte data[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    byte buf[16] = {0};
+
+    ASSERT_EQ(0U, cache.get(file, 0, buf));
+    cache.put(file, 0, data, 16);
+    cache.put(file, 6, data, 4);
+    ASSERT_EQ(16U, cache.get(file, 0, buf));
+    ASSERT_EQ(0, memcmp(buf, data, 16));
+    ASSERT_EQ(4U, cache.get(file, 6, buf));
+    ASSERT_EQ(0U, cache.get(file, 1, buf));
+    std::remove(cacheFile.c_str());
+}
+
+TEST(BlockCache, isSharedBetweenInstances)
+{
+    std::remove(cacheFile.c_str());
+    const uint64_t file = BlockCache::fileKey("http://host/file.jpg", "\"etag\"", 100);
+    const byte data[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    byte buf[16] = {0};
+    {
+        BlockCache cache(cacheDir, 16, 1024);
+        if (!cache.good()) return;
+        cache.put(file, 3, data, 16);
+    }
+    BlockCache cache(cacheDir, 16, 1024);
+    ASSERT_EQ(16U, cache.get(file, 3, buf));
+    ASSERT_EQ(0, memcmp(buf, data, 16));
+    std::remove(cacheFile.c_str());
+}
+
+TEST(BlockCache, replacesAnInvalidFileWithoutTruncatingItsMapping)
+{
+    std::remove(cacheFile.c_str());
+    const uint64_t file = BlockCache::fileKey("http://host/file.jpg", "\"etag\"", 100);
+    const byte data[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    byte buf[16] = {0};
+    BlockCache mapped(cacheDir, 16, 1024);
+    if (!mapped.good()) return;
+    mapped.put(file, 3, data, 16);
+
+    // an other version of the cache file, of the same size
+    FILE* f = std::fopen(cacheFile.c_str(), "r+b");
+    ASSERT_NE(nullptr, f);
+    ASSERT_EQ(1U, std::fwrite("exv2blk0", 8, 1, f));
+    std::fclose(f);
+
+    BlockCache cache(cacheDir, 16, 1024);
+    ASSERT_TRUE(cache.good());
+    ASSERT_EQ(0U, cache.get(file, 3, buf));
+    ASSERT_EQ(16U, mapped.get(file, 3, buf));
+    ASSERT_EQ(0, memcmp(buf, data, 16));
+    std::remove(cacheFile.c_str());
+}
+
+TEST(BlockCache, keysDependOnTheValidator)
+{
+    ASSERT_NE(BlockCache::fileKey("http://host/file.jpg", "\"v1\"", 100),
+              BlockCache::fileKey("http://host/file.jpg", "\"v2\"", 100));
+    ASSERT_NE(BlockCache::fileKey("http://host/file.jpg", "\"v1\"", 100),
+              BlockCache::fileKey("http://host/file.jpg", "\"v1\"", 101));
+}
+
+TEST(BlockCache, evictsBlocksWhenFull)
+{
+    std::remove(cacheFile.c_str());
+    // the minimum of one set with eight blocks
+    BlockCache cache(cacheDir, 16, 16);
+    if (!cache.good()) return;
+    const uint64_t file = BlockCache::fileKey("http://host/file.jpg", "\"etag\"", 1000);
+    const byte data[16] = {0};
+    byte buf[16];
+    for (uint64_t block = 0; block < 9; block++) {
+        cache.put(file, block, data, 16);
+    }
+    ASSERT_EQ(0U, cache.get(file, 0, buf));
+    ASSERT_EQ(16U, cache.get(file, 8, buf));
+    std::remove(cacheFile.c_str());
+}
@@ -104,6 +104,11 @@ TEST(getEnv, getsDefaultValueWhenExpectedEnvVariableDoesNotExist)
 {
     ASSERT_STREQ("/exiv2.php", getEnv(envHTTPPOST).c_str());
     ASSERT_STREQ("40", getEnv(envTIMEOUT).c_str());
+    ASSERT_STREQ("", getEnv(envREMOTECACHE).c_str());
+    ASSERT_STREQ("64", getEnv(envREMOTECACHESIZE).c_str());
+    ASSERT_STREQ("0", getEnv(envATOMICWRITE).c_str());
+    ASSERT_STREQ("", getEnv(envINDEXCACHE).c_str());
+    ASSERT_STREQ("1", getEnv(envDECODETHREADS).c_str());
 }
 
 TEST(getEnv, getsProperValuesWhenExpectedEnvVariableExists)
@@ -124,7 +129,7 @@ TEST(getEnv, getsProperValuesWhenExpectedEnvVariableExists)
 
 TEST(getEnv, throwsWhenKeyDoesNotExist)
 {
-    ASSERT_THROW(getEnv(static_cast<EnVar>(3)), std::out_of_range);
+    ASSERT_THROW(getEnv(static_cast<EnVar>(7)), std::out_of_range);
 }
 
 TEST(urlencode, encodesGivenUrl)
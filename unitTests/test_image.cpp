@@ -0,0 +1,169 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <exiv2/exiv2.hpp>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Exiv2;
+
+namespace {
+    //! Return the contents of the IO of the image
+    DataBuf contents(Image& image)
+    {
+        BasicIo& io = image.io();
+        io.open();
+        DataBuf buf(static_cast<long>(io.size()));
+        io.read(buf.data(), buf.size());
+        io.close();
+        return buf;
+    }
+
+    //! Open an image in memory which owns a copy of the data
+    Image::UniquePtr openCopy(const DataBuf& buf)
+    {
+        BasicIo::UniquePtr io(new MemIo);
+        io->write(buf.c_data(), buf.size());
+        return ImageFactory::open(std::move(io));
+    }
+
+    //! Open an in-memory copy of a file from the test data
+    Image::UniquePtr openCopy(const std::string& name)
+    {
+        return openCopy(readFile(std::string(TESTDATA_PATH) + "/" + name));
+    }
+
+    //! Return a TIFF image whose XMP packet was read but is not decoded yet
+    Image::UniquePtr tiffWithDeferredXmp()
+    {
+        Image::UniquePtr tiff = openCopy("mini9.tif");
+        tiff->readMetadata();
+        tiff->xmpData()["Xmp.dc.title"] = "MARKER";
+        tiff->writeMetadata();
+        Image::UniquePtr image = openCopy(contents(*tiff));
+        image->readMetadata();
+        return image;
+    }
+
+    //! Write the metadata of the image, read them back and return the title
+    std::string titleAfterWrite(Image& image)
+    {
+        image.writeMetadata();
+        Image::UniquePtr reread = openCopy(contents(image));
+        reread->readMetadata();
+        const XmpData& xmpData = reread->xmpData();
+        auto pos = xmpData.findKey(XmpKey("Xmp.dc.title"));
+        return pos == xmpData.end() ? std::string() : pos->toString();
+    }
+}  // namespace
+
+TEST(AnImage, keepsDeferredXmpCopiedWithSetMetadata)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+    ASSERT_TRUE(source->xmpData().decodePending());
+
+    Image::UniquePtr target = openCopy("exiv2-bug540.jpg");
+    target->readMetadata();
+    target->setMetadata(*source);
+    ASSERT_EQ("lang=\"x-default\" MARKER", titleAfterWrite(*target));
+}
+
+TEST(AnImage, keepsDeferredXmpCopiedWithSetXmpData)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+    ASSERT_TRUE(source->xmpData().decodePending());
+
+    Image::UniquePtr target = openCopy("exiv2-bug540.jpg");
+    target->readMetadata();
+    target->setXmpData(source->xmpData());
+    ASSERT_EQ("lang=\"x-default\" MARKER", titleAfterWrite(*target));
+}
+
+TEST(AnImage, keepsDeferredXmpCopiedToATiffImage)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+
+    Image::UniquePtr target = openCopy("mini9.tif");
+    target->readMetadata();
+    target->setXmpData(source->xmpData());
+    ASSERT_EQ("lang=\"x-default\" MARKER", titleAfterWrite(*target));
+}
+
+TEST(XmpData, decodesADeferredPacketOnceForConcurrentReaders)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+    const XmpData& xmpData = source->xmpData();
+    ASSERT_TRUE(xmpData.decodePending());
+
+    std::vector<long> counts(4);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        readers.emplace_back([&xmpData, &counts, i] { counts[i] = xmpData.count(); });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (auto count : counts) {
+        ASSERT_EQ(1, count);
+    }
+    ASSERT_FALSE(xmpData.decodePending());
+}
+
+TEST(XmpData, copiesADeferredPacketWhileOtherThreadsDecodeIt)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+    const XmpData& xmpData = source->xmpData();
+    ASSERT_TRUE(xmpData.decodePending());
+
+    std::vector<XmpData> copies(4);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&xmpData] { xmpData.count(); });
+    for (auto& copy : copies) {
+        threads.emplace_back([&xmpData, &copy] { copy = xmpData; });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& copy : copies) {
+        ASSERT_EQ(1, copy.count());
+        auto title = copy.findKey(XmpKey("Xmp.dc.title"));
+        ASSERT_NE(copy.end(), title);
+        ASSERT_EQ("lang=\"x-default\" MARKER", title->toString());
+    }
+}
+
+TEST(XmpData, movesADeferredPacket)
+{
+    Image::UniquePtr source = tiffWithDeferredXmp();
+    XmpData xmpData(source->xmpData());
+    ASSERT_TRUE(xmpData.decodePending());
+
+    XmpData moved(std::move(xmpData));
+    ASSERT_TRUE(moved.decodePending());
+    XmpData assigned;
+    assigned = std::move(moved);
+    ASSERT_TRUE(assigned.decodePending());
+    ASSERT_EQ(1, assigned.count());
+    ASSERT_FALSE(assigned.decodePending());
+}
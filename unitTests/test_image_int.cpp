@@ -66,3 +66,31 @@ TEST(binaryToString, nonZeroStart)
     // start @ index 3, read until end
     checkBinaryToString(makeSlice(buf, 3, sizeof(buf)), "...e..a");
 }
+
+TEST(findBytes, findsTheFirstOccurrenceInTheRange)
+{
+    const std::string text("<?x <?xpacket <?xpacket end");
+    auto data = reinterpret_cast<const Exiv2::byte*>(text.data());
+
+    ASSERT_EQ(4U, findBytes(data, 0, text.size(), "<?xpacket"));
+    ASSERT_EQ(14U, findBytes(data, 5, text.size(), "<?xpacket"));
+    ASSERT_EQ(14U, findBytes(data, 14, text.size(), "<?xpacket end"));
+    // the needle must end within the range
+    ASSERT_EQ(26U, findBytes(data, 0, 26, "<?xpacket end"));
+    ASSERT_EQ(text.size(), findBytes(data, 0, text.size(), "?>"));
+    ASSERT_EQ(text.size(), findBytes(data, 30, text.size(), "<"));
+}
+
+TEST(findEither, findsTheFirstOfTwoBytes)
+{
+    std::string text(1000, 'a');
+    text[700] = '\n';
+    text[900] = '\r';
+    auto data = reinterpret_cast<const Exiv2::byte*>(text.data());
+
+    ASSERT_EQ(700U, findEither(data, 0, text.size(), '\r', '\n'));
+    ASSERT_EQ(900U, findEither(data, 701, text.size(), '\r', '\n'));
+    ASSERT_EQ(900U, findEither(data, 701, text.size(), '\n', '\r'));
+    ASSERT_EQ(600U, findEither(data, 0, 600, '\r', '\n'));
+    ASSERT_EQ(1000U, findEither(data, 901, text.size(), '\r', '\n'));
+}
@@ -0,0 +1,110 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "structindex_int.hpp"
+#include "config.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sys/stat.h>
+
+using namespace Exiv2;
+using Exiv2::Internal::FileRanges;
+using Exiv2::Internal::StructureIndex;
+
+namespace {
+    const std::string indexDir(".");
+    const std::string dataFile("test_structindex_int.dat");
+
+    void writeFile(const std::string& path, size_t size)
+    {
+        FILE* fp = std::fopen(path.c_str(), "wb");
+        for (size_t i = 0; i < size; i++) std::fputc('x', fp);
+        std::fclose(fp);
+    }
+
+    //! Remove the index of the file at \em path
+    void removeIndex(const std::string& path)
+    {
+        struct stat buf;
+        if (::stat(path.c_str(), &buf) != 0) return;
+        char name[48];
+        std::snprintf(name, sizeof(name), "exiv2-%llx-%llx.idx", static_cast<unsigned long long>(buf.st_dev),
+                      static_cast<unsigned long long>(buf.st_ino));
+        std::remove((indexDir + EXV_SEPARATOR_STR + name).c_str());
+    }
+}
+
+TEST(StructureIndex, mergesRangesWhichAreClose)
+{
+    FileRanges ranges{{100, 10}, {0, 8}, {105, 20}, {130, 1}, {200, 5}};
+    StructureIndex::merge(ranges, 5);
+    ASSERT_EQ(3U, ranges.size());
+    ASSERT_EQ(std::make_pair(0L, 8L), ranges[0]);
+    ASSERT_EQ(std::make_pair(100L, 31L), ranges[1]);
+    ASSERT_EQ(std::make_pair(200L, 5L), ranges[2]);
+}
+
+TEST(StructureIndex, isFoundWhenTheFileIsUnchanged)
+{
+    writeFile(dataFile, 100);
+    {
+        StructureIndex index(indexDir, dataFile);
+        if (index.recorder() == nullptr) return; // not available on this platform
+        ASSERT_FALSE(index.found());
+        index.recorder()->emplace_back(50, 10);
+        index.recorder()->emplace_back(0, 8);
+        index.save();
+    }
+    StructureIndex index(indexDir, dataFile);
+    ASSERT_TRUE(index.found());
+    ASSERT_EQ(nullptr, index.recorder());
+    // ranges which are close are merged when the index is saved
+    ASSERT_EQ(1U, index.ranges().size());
+    ASSERT_EQ(std::make_pair(0L, 60L), index.ranges()[0]);
+    removeIndex(dataFile);
+    std::remove(dataFile.c_str());
+}
+
+TEST(StructureIndex, isNotFoundWhenTheFileChanged)
+{
+    writeFile(dataFile, 100);
+    {
+        StructureIndex index(indexDir, dataFile);
+        if (index.recorder() == nullptr) return;
+        index.recorder()->emplace_back(0, 8);
+        index.save();
+    }
+    writeFile(dataFile, 101);
+    StructureIndex index(indexDir, dataFile);
+    ASSERT_FALSE(index.found());
+    ASSERT_TRUE(index.ranges().empty());
+    removeIndex(dataFile);
+    std::remove(dataFile.c_str());
+}
+
+TEST(StructureIndex, isNotUsedWithoutADirectory)
+{
+    writeFile(dataFile, 100);
+    StructureIndex index("", dataFile);
+    ASSERT_FALSE(index.found());
+    ASSERT_EQ(nullptr, index.recorder());
+    std::remove(dataFile.c_str());
+}
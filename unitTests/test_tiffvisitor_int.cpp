@@ -0,0 +1,135 @@
+// ***************************************************************** -*- C++ -*-
+/*
+ * Copyright (C) 2004-2021 Exiv2 authors
+ * This program is part of the Exiv2 distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, 5th Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <exiv2/exiv2.hpp>
+#include "tiffcomposite_int.hpp"
+#include "tiffimage_int.hpp"
+#include "tiffvisitor_int.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace Exiv2;
+using namespace Exiv2::Internal;
+
+namespace {
+    //! Return the entry with \em tag and \em group of the tree \em root
+    const TiffEntryBase* findEntry(TiffComponent* root, uint16_t tag, IfdId group)
+    {
+        TiffFinder finder(tag, group);
+        root->accept(finder);
+        return dynamic_cast<const TiffEntryBase*>(finder.result());
+    }
+
+    /*!
+      Encode the Exif metadata of a DNG with a new Exif.Image.Artist, as
+      TiffParserWorker::encode() does. There are no primary groups, they only
+      matter for the image tags.
+     */
+    class AnIntrusiveRewrite : public ::testing::Test {
+    protected:
+        void SetUp() override
+        {
+            file_ = readFile(std::string(TESTDATA_PATH) + "/IMG_1361.dng");
+            ASSERT_TRUE(header_.read(file_.c_data(), file_.size()));
+            Image::UniquePtr image = ImageFactory::open(std::string(TESTDATA_PATH) + "/IMG_1361.dng");
+            image->readMetadata();
+            exifData_ = image->exifData();
+            exifData_["Exif.Image.Artist"] = "An artist name which does not fit into the directory entry";
+
+            // Parse the file, as TiffParserWorker::parse() does
+            parsedTree_ = TiffCreator::create(Tag::root, ifdIdNotSet);
+            ASSERT_NE(nullptr, parsedTree_.get());
+            parsedTree_->setStart(file_.c_data() + header_.offset());
+            TiffRwState state(header_.byteOrder(), 0);
+            TiffReader reader(file_.c_data(), file_.size(), parsedTree_.get(), state);
+            parsedTree_->accept(reader);
+            reader.postProcess();
+
+            TiffEncoder encoder(exifData_, iptcData_, xmpData_, parsedTree_.get(), false, &primaryGroups_, &header_,
+                                TiffMapping::findEncoder);
+            parsedTree_->accept(encoder);
+            ASSERT_TRUE(encoder.dirty());
+            cleanEntries_ = encoder.cleanEntries();
+
+            createdTree_ = TiffCreator::create(Tag::root, ifdIdNotSet);
+            TiffCopier copier(createdTree_.get(), Tag::root, &header_, &primaryGroups_);
+            parsedTree_->accept(copier);
+        }
+
+        void add(const TiffEntryIndex* pCleanEntries)
+        {
+            TiffEncoder encoder(exifData_, iptcData_, xmpData_, createdTree_.get(), false, &primaryGroups_, &header_,
+                                TiffMapping::findEncoder);
+            encoder.add(createdTree_.get(), parsedTree_.get(), Tag::root, pCleanEntries);
+        }
+
+        DataBuf file_;
+        TiffHeader header_;
+        ExifData exifData_;
+        IptcData iptcData_;
+        XmpData xmpData_;
+        PrimaryGroups primaryGroups_;
+        TiffEntryIndex cleanEntries_;
+        TiffComponent::UniquePtr parsedTree_;
+        TiffComponent::UniquePtr createdTree_;
+    };
+}
+
+TEST_F(AnIntrusiveRewrite, knowsTheEntriesOfCleanGroups)
+{
+    ASSERT_EQ(0U, cleanEntries_.count(std::make_pair(ifd0Id, uint16_t(0x0110))));
+    ASSERT_EQ(1U, cleanEntries_.count(std::make_pair(exifId, uint16_t(0x829a))));
+    ASSERT_EQ(1U, cleanEntries_.count(std::make_pair(gpsId, uint16_t(0x0002))));
+}
+
+TEST_F(AnIntrusiveRewrite, copiesTheValuesOfCleanGroupsVerbatim)
+{
+    add(&cleanEntries_);
+
+    // Exif.Photo.ExposureTime and Exif.GPSInfo.GPSLatitude point to the data of the file
+    for (auto&& key : {std::make_pair(uint16_t(0x829a), exifId), std::make_pair(uint16_t(0x0002), gpsId)}) {
+        const TiffEntryBase* source = findEntry(parsedTree_.get(), key.first, key.second);
+        const TiffEntryBase* created = findEntry(createdTree_.get(), key.first, key.second);
+        ASSERT_NE(nullptr, source);
+        ASSERT_NE(nullptr, created);
+        ASSERT_EQ(source->pData(), created->pData());
+        ASSERT_EQ(nullptr, created->pValue());
+        ASSERT_EQ(source->count(), created->count());
+        ASSERT_EQ(source->tiffType(), created->tiffType());
+    }
+    // Exif.Image.Model is in the dirty IFD0 and encoded again
+    const TiffEntryBase* source = findEntry(parsedTree_.get(), 0x0110, ifd0Id);
+    const TiffEntryBase* created = findEntry(createdTree_.get(), 0x0110, ifd0Id);
+    ASSERT_NE(nullptr, created);
+    ASSERT_NE(source->pData(), created->pData());
+    ASSERT_NE(nullptr, created->pValue());
+}
+
+TEST_F(AnIntrusiveRewrite, encodesAllValuesWithoutCleanEntries)
+{
+    add(nullptr);
+
+    const TiffEntryBase* source = findEntry(parsedTree_.get(), 0x829a, exifId);
+    const TiffEntryBase* created = findEntry(createdTree_.get(), 0x829a, exifId);
+    ASSERT_NE(nullptr, created);
+    ASSERT_NE(source->pData(), created->pData());
+    ASSERT_NE(nullptr, created->pValue());
+}
@@ -109,3 +109,21 @@ TEST(Rational, floatToRationalCast)
     ASSERT_EQ(minus_inf.first, -1);
     ASSERT_EQ(minus_inf.second, 0);
 }
+
+TEST(appendDecimal, matchesStreamOutput)
+{
+    static const int64_t values[] = {0,
+                                     7,
+                                     -7,
+                                     65535,
+                                     -32768,
+                                     4294967295LL,
+                                     std::numeric_limits<int64_t>::max(),
+                                     std::numeric_limits<int64_t>::min()};
+
+    for (auto value : values) {
+        std::string buf("x");
+        appendDecimal(buf, value);
+        ASSERT_EQ("x" + toString(value), buf);
+    }
+}